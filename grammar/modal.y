@@ -32,6 +32,9 @@
   extern char yytext[];
 
   void yyerror(const char* msg);
+
+  // a very deep formula needs a deep parser stack (it grows in the heap, by default it stops at 10000)
+  #define YYMAXDEPTH 10000000
 %}
 
 /*** Bison declarations ***/
@@ -104,8 +104,21 @@ class BooleanConstant : public Variable {
        * @param[in] kripke the Kripke model which is maybe a solution for the Formula.
        * 
        * @param[in] world the world in which we perform the check. Irrelevant here;
+       *
+       * @param[in,out] context the context of the check. Irrelevant here;
+       */
+      virtual unsigned int checkBranch(Kripke & kripke, unsigned int world, CheckContext & context);
+
+      /**
+       * @brief This method will label every world with OK if the constant is True, KO otherwise.
+       *
+       * @param[in] kripke the Kripke model which is maybe a solution for the Formula.
+       * 
+       * @param[out] labels labels[w] is {OK,KO} according to the value of the constant.
+       *
+       * @param[in,out] context the context of the check. Irrelevant here;
        */
-      virtual unsigned int checkBranch(Kripke & kripke, unsigned int world);
+      virtual void labelWorlds(Kripke & kripke, WorldSet & labels, CheckContext & context) { labels.assign(kripke.getNbWorlds(), value ? OK : KO); }
 
 	private:
 
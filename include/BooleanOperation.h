@@ -27,6 +27,8 @@
 
 #include "Operation.h"
 
+#include <stdint.h>
+
 /**
  * \file BooleanOperation.h
  * @brief Description of the class BooleanOperation.
@@ -130,11 +132,128 @@ public:
         *
         * @param[in] world the world in which we are checking the satisfiability of the current BooleanOperation.
 	    *
+        * @param[in,out] context the context of the check (its reason is set if the result is {KO,UNKNOWN}).
+	    *
         * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current ModalOperation.
         * 
         */
-  		virtual unsigned int checkBranch(Kripke & kripke, unsigned int world);
+  		virtual unsigned int checkBranch(Kripke & kripke, unsigned int world, CheckContext & context);
+
+       /**
+        * @brief This method will check the branch in the world world, each child which is not a leaf being a task of the pool of the context.
+        * 
+        * A KO under an AND (an OK under an OR) cancels the tasks of the other children.
+        *
+        * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+        *
+        * @param[in] world the world in which we are checking the satisfiability of the current BooleanOperation.
+        *
+        * @param[in,out] context the context of the current task (with a pool, and a group telling if the result is still needed).
+        *
+        * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current BooleanOperation, NOT_YET if the check was cancelled.
+        */
+  		virtual unsigned int checkBranchInParallel(Kripke & kripke, unsigned int world, CheckContext & context);
+
+       /**
+        * @brief This method will compile the BooleanOperation into masks of the valuation rows, if every child is a literal.
+        *
+        * A literal p'v' (~p'v') is OK if the bit 2(v-1) (2(v-1)+1) of the row is set, and KO if the other bit of its cell is set.
+        * The OK bits and the KO bits of the children are gathered by word of the row, so a clause (a cube) is checked in a few tests,
+        * with the same result and reason as the check of its children one by one.
+        *
+        * @return true if the BooleanOperation was compiled (its results are then not stored in the cache).
+        */
+  		bool compileLiteralMasks();
+
+       /**
+        * @brief This method will compute, for every world of the solution kripke, if the BooleanOperation is {OK,KO,UNKNOWN} in it.
+        * 
+        * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+        *
+        * @param[out] labels labels[w] is {OK,KO,UNKNOWN} according to the labels of the children in w.
+        *
+        * @param[in,out] context the context of the check (its cache gets the labels of the Operations, see Term::storeLabels).
+        */
+  		virtual void labelWorlds(Kripke & kripke, WorldSet & labels, CheckContext & context);
+
+private:
+
+       /**
+        * \struct ChildStatistics
+        *
+        * @brief What the adaptive mode observed about one child.
+        */
+       struct ChildStatistics {
+
+           /** @brief How many times the child was checked. */
+           uint32_t nbChecked;
+
+           /** @brief How many times the child decided the result (KO under an AND, OK under an OR). */
+           uint32_t nbDecisive;
+
+           /** @brief How many Terms were checked for the child (see CheckContext::countCheck). */
+           uint64_t work;
+       };
+
+       /**
+        * \struct LiteralMask
+        *
+        * @brief The bits of one word of the valuation row which give the results of the literals of a clause (a cube).
+        */
+       struct LiteralMask {
+
+           /** @brief The index of the word in the row. */
+           uint32_t word;
+
+           /** @brief The bits set if a literal is OK. */
+           uint64_t ok;
+
+           /** @brief The bits set if a literal is KO. */
+           uint64_t ko;
+       };
+
+       /**
+        * @brief This method will check the branch like checkBranch, from the masks of the literals (see BooleanOperation::compileLiteralMasks).
+        *
+        * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+        *
+        * @param[in] world the world in which we are checking the satisfiability of the current BooleanOperation.
+        *
+        * @param[in,out] context the context of the check (its reason is set if the result is {KO,UNKNOWN}).
+        *
+        * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current BooleanOperation.
+        */
+       unsigned int checkLiteralMasks(Kripke & kripke, unsigned int world, CheckContext & context);
+
+       /**
+        * @brief This method will check the branch like checkBranch, the children in the order learnt from the previous checks.
+        *
+        * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+        *
+        * @param[in] world the world in which we are checking the satisfiability of the current BooleanOperation.
+        *
+        * @param[in,out] context the context of the check (its reason is set if the result is {KO,UNKNOWN}).
+        *
+        * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current BooleanOperation.
+        */
+       unsigned int checkAdaptively(Kripke & kripke, unsigned int world, CheckContext & context);
+
+       /**
+        * @brief This method will sort the children, cheap and decisive ones first, and forget half of what was observed.
+        */
+       void adaptOrder();
+
+       /** @brief The masks of the literals, by word of the row (empty if a child is not a literal). */
+       vector<LiteralMask> masks;
+
+       /** @brief In the adaptive mode, the order in which the children are checked (empty until the first adaptive check). */
+       vector<uint32_t> order;
+
+       /** @brief In the adaptive mode, what was observed about each child. */
+       vector<ChildStatistics> statistics;
 
+       /** @brief In the adaptive mode, how many checks are left before the children are sorted again. */
+       uint32_t checksBeforeAdapting;
 };
 
 #endif
\ No newline at end of file
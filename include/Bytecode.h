@@ -0,0 +1,210 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+#ifndef BYTECODE_H_INCLUDED
+#define BYTECODE_H_INCLUDED
+
+#include "Term.h"
+
+#include <stdint.h>
+
+/**
+ * \file Bytecode.h
+ * @brief Description of the struct Instruction and of the class Bytecode.
+ *
+ * A Bytecode is the simplified formula lowered into one array of instructions,
+ * checked by a small interpreter instead of the virtual methods of the Terms.
+ *
+ * @version 1.0
+ */
+
+/**
+ * @brief We declare an enumerate type for the instructions of a Bytecode.
+ */
+enum opcode_t {
+
+  /** @brief a literal, its variable in arg and its polarity in negated */
+  I_LITERAL = 0,
+
+  /** @brief the constant true */
+  I_TRUE,
+
+  /** @brief the constant false */
+  I_FALSE,
+
+  /** @brief a n-ary and, its arg children follow it */
+  I_AND,
+
+  /** @brief a n-ary or, its arg children follow it */
+  I_OR,
+
+  /** @brief a box, arg is its chain of modal operators (see Term::getModalTermChainSize) and its child follows it */
+  I_BOX,
+
+  /** @brief a diamond, arg is its chain of modal operators and its child follows it */
+  I_DIAMOND
+};
+
+/**
+ * \struct Instruction
+ *
+ * @brief One Term of the formula, in 16 bytes.
+ *
+ * The instructions are in prefix order: the first child of an instruction is the next instruction,
+ * and skip is the index after its last descendant (so the next sibling, or where a short-circuit jumps).
+ */
+struct Instruction {
+
+    /** @brief What the instruction is (an opcode_t). */
+    uint8_t opcode;
+
+    /** @brief For I_LITERAL, 1 if the literal is negated. */
+    uint8_t negated;
+
+    /** @brief The variable (I_LITERAL), the number of children (I_AND, I_OR) or the chain size (I_BOX, I_DIAMOND). */
+    uint32_t arg;
+
+    /** @brief The index after the last descendant of the instruction. */
+    uint32_t skip;
+
+    /** @brief The id of the Term (see Term::setTermIds), to store the results in the cache. */
+    uint32_t termId;
+};
+
+/**
+ * \class Bytecode
+ *
+ * @brief The instructions of a formula, and the interpreter which checks them in a world.
+ *
+ * The results, the short-circuits, the use of the cache and the reasons are exactly the ones of Term::check.
+ * The Terms are only kept to give the reasons of a {KO,UNKNOWN} result.
+ */
+class Bytecode {
+
+public:
+
+    /**
+     * @brief To construct a Bytecode, we need the root of the simplified formula (with its chains and its ids).
+     *
+     * @param[in] root the root of the formula.
+     */
+    Bytecode(Term* root);
+
+    /**
+     * @brief This method will check if the formula is {OK,KO,UNKNOWN} in the world w.
+     *
+     * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+     *
+     * @param[in] w the world in which we are checking the satisfiability of the formula.
+     *
+     * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+     *
+     * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the formula.
+     */
+    unsigned int check(Kripke & kripke, unsigned int w, CheckContext & context) const;
+
+    /**
+     * @brief This method will return the number of instructions.
+     *
+     * @return the number of Terms in the formula.
+     */
+    size_t size() const { return code.size(); }
+
+    /**
+     * @brief This method will return the instruction pc.
+     *
+     * @param[in] pc the index of the instruction.
+     *
+     * @return the instruction (see NativeChecker, which translates them into C++).
+     */
+    const Instruction & getInstruction(uint32_t pc) const { return code[pc]; }
+
+    /**
+     * @brief This method will return the Terms of the instructions.
+     *
+     * @return the Terms, in the order of the instructions.
+     */
+    Term* const* getTerms() const { return &terms[0]; }
+
+private:
+
+    /**
+     * @brief This method will append the instructions of a Term and of its sub-formulae.
+     *
+     * @param[in] term the Term to compile.
+     */
+    void compile(Term* term);
+
+    /**
+     * @brief This method will run the instruction pc of a Term without children in the world w.
+     *
+     * @param[in] pc the index of the instruction.
+     *
+     * @param[in] w the world in which the instruction is checked.
+     *
+     * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+     *
+     * @param[in,out] context the context of the check.
+     *
+     * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the Term of the instruction.
+     */
+    inline unsigned int runLeaf(uint32_t pc, unsigned int w, Kripke & kripke, CheckContext & context) const;
+
+    /**
+     * @brief This method will run the instruction pc in the world w.
+     *
+     * @param[in] pc the index of the instruction.
+     *
+     * @param[in] w the world in which the instruction is checked.
+     *
+     * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+     *
+     * @param[in,out] context the context of the check.
+     *
+     * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the Term of the instruction.
+     */
+    inline unsigned int run(uint32_t pc, unsigned int w, Kripke & kripke, CheckContext & context) const;
+
+    /**
+     * @brief This method will run the instruction pc of an Operation in the world w (the cache was already looked at).
+     *
+     * @param[in] pc the index of the instruction.
+     *
+     * @param[in] w the world in which the instruction is checked.
+     *
+     * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+     *
+     * @param[in,out] context the context of the check.
+     *
+     * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the Operation of the instruction.
+     */
+    unsigned int runOperation(uint32_t pc, unsigned int w, Kripke & kripke, CheckContext & context) const;
+
+    /** @brief The instructions, in prefix order. */
+    vector<Instruction> code;
+
+    /** @brief The Term of each instruction (only to give the reasons). */
+    vector<Term*> terms;
+};
+
+#endif
@@ -0,0 +1,221 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+#ifndef CHECK_CACHE_H_INCLUDED
+#define CHECK_CACHE_H_INCLUDED
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+
+#include "Def.h"
+
+/**
+ * \file CheckCache.h
+ * @brief Description of the class CheckCache.
+ *
+ * A CheckCache remembers the result {OK,KO,UNKNOWN} of a sub-formula in a world,
+ * so the same sub-formula is never checked twice in the same world.
+ *
+ * @version 1.0
+ */
+
+/**
+ * \class CheckCache
+ *
+ * @brief Memo table keyed by (sub-formula id, world) and holding {OK,KO,UNKNOWN}.
+ *
+ * If |Terms| x |Worlds| fits in the memory budget, the table is dense: 2 bits per entry.
+ * Otherwise, the table is hashed: buckets of 4 slots, and when a bucket is full one of its slots is evicted.
+ * A slot holds the key and the result in 64 bits, so only the Terms whose id is less than HASHED_TERMS are stored.
+ *
+ * A result is stored as (result ^ 3), so an entry of 0 is "not checked yet": the tables are allocated zeroed,
+ * and the pages of memory are only written when results are stored in them.
+ * If the table can not be allocated, a smaller hashed one is tried (see CheckCache::isAllocated).
+ *
+ * A shared cache can be used by several threads at the same time: the entries are read and written atomically
+ * (a dense entry only goes from 0 to a result, so its bits are set with an atomic or).
+ *
+ * The hits and misses are counted by the CheckContext of each check, not by the cache.
+ */
+class CheckCache {
+
+public:
+
+    /**
+     * @brief To construct a cache, we need the size of the problem and how much memory we can use.
+     *
+     * @param[in] nbTerms the number of sub-formulae (the ids are in [0,nbTerms[).
+     *
+     * @param[in] nbWorlds the number of worlds in the Kripke model.
+     *
+     * @param[in] budget the maximum number of bytes that the cache can use.
+     */
+    CheckCache(unsigned int nbTerms, unsigned int nbWorlds, size_t budget);
+
+    /**
+     * @brief This method is the destructor, it will just free the table.
+     */
+    ~CheckCache();
+
+    /**
+     * @brief This method will return the stored result of the Term 'term' in the world 'world'.
+     *
+     * @param[in] term the id of the Term.
+     *
+     * @param[in] world the world in which the Term was checked.
+     *
+     * @return {OK,KO,UNKNOWN} if the result is stored, NOT_YET otherwise.
+     */
+    inline unsigned int lookup(unsigned int term, unsigned int world) {
+
+      if(dense) {
+        uint64_t idx = (uint64_t) term * nbWorlds + world;
+        return ((__atomic_load_n(&table[idx >> 2], __ATOMIC_RELAXED) >> ((idx & 3) << 1)) & 3) ^ 3;
+      }
+
+      if(term >= HASHED_TERMS) return NOT_YET;
+
+      return lookupHashed(((uint64_t) term << 32) | world);
+    }
+
+    /**
+     * @brief This method will store the result of the Term 'term' in the world 'world'.
+     *
+     * @param[in] term the id of the Term.
+     *
+     * @param[in] world the world in which the Term was checked.
+     *
+     * @param[in] result {OK,KO,UNKNOWN} the result of the check.
+     */
+    inline void store(unsigned int term, unsigned int world, unsigned int result) {
+
+      if(dense) {
+        uint64_t idx = (uint64_t) term * nbWorlds + world;
+        unsigned int shift = (idx & 3) << 1;
+
+        /* An empty entry is 00, so storing a result only sets bits: the other entries of the byte are kept, even if another thread stores one. */
+        if(shared) __atomic_fetch_or(&table[idx >> 2], (uint8_t) ((result ^ 3) << shift), __ATOMIC_RELAXED);
+        else       table[idx >> 2] = (table[idx >> 2] & ~(3 << shift)) | ((result ^ 3) << shift);
+      } else if(term < HASHED_TERMS) {
+        storeHashed(((uint64_t) term << 32) | world, result);
+      }
+    }
+
+    /**
+     * @brief This method will tell if the table is dense or hashed.
+     *
+     * @return true if the table is dense, false if it is hashed.
+     */
+    bool isDense() { return dense; }
+
+    /**
+     * @brief This method will tell if a table could be allocated (otherwise the cache can not be used).
+     *
+     * @return true if the dense or the hashed table is allocated.
+     */
+    bool isAllocated() { return table != NULL || slots != NULL; }
+
+    /**
+     * @brief This method will tell if the cache is used by several threads at the same time.
+     *
+     * @param[in] shared true if several threads look up and store results at the same time.
+     */
+    void setShared(bool shared) { this->shared = shared; }
+
+    /** @brief This method will return how many results were evicted to make room for new ones. */
+    uint64_t getNbEvictions() { return nbEvictions; }
+
+    /**
+     * @brief This method will display the layout and the evictions of the cache as comment lines.
+     *
+     * @param[in] f the FILE* in which we want to display the statistics.
+     */
+    void displayStatistics(FILE* f = stdout);
+
+private:
+
+    /** @brief The number of Term ids in a slot of the hashed table: (term << 32 | world) << 2 has to keep every bit of the term. */
+    static const unsigned int HASHED_TERMS = 1u << 30;
+
+    /** @brief An empty slot in the hashed table (a stored result is never 0, see CheckCache). */
+    static const uint64_t EMPTY_SLOT = 0;
+
+    /**
+     * @brief This method will look for a key in the hashed table.
+     *
+     * @param[in] key (term << 32 | world)
+     *
+     * @return the stored result, NOT_YET if the key is not in the table.
+     */
+    unsigned int lookupHashed(uint64_t key);
+
+    /**
+     * @brief This method will store a key in the hashed table, evicting a slot of the bucket if it is full.
+     *
+     * @param[in] key (term << 32 | world)
+     *
+     * @param[in] result {OK,KO,UNKNOWN} the result to store.
+     */
+    void storeHashed(uint64_t key, unsigned int result);
+
+    /**
+     * @brief This method will return the first slot of the bucket of a key.
+     *
+     * @param[in] key (term << 32 | world)
+     */
+    inline uint64_t bucketOf(uint64_t key) {
+
+      key ^= key >> 33; key *= 0xff51afd7ed558ccdULL;
+      key ^= key >> 33; key *= 0xc4ceb9fe1a85ec53ULL;
+      key ^= key >> 33;
+
+      return (key & bucketMask) << 2;
+    }
+
+    /** @brief true if the table is a dense matrix [nbTerms][nbWorlds]. */
+    bool dense;
+
+    /** @brief true if several threads use the cache at the same time. */
+    bool shared;
+
+    /** @brief The number of worlds (the width of a line in the dense table). */
+    unsigned int nbWorlds;
+
+    /** @brief The dense table, 4 entries of 2 bits per byte. */
+    uint8_t* table;
+
+    /** @brief The hashed table, each slot is (key << 2 | (result ^ 3)). */
+    uint64_t* slots;
+
+    /** @brief (number of buckets - 1), the number of buckets being a power of 2. */
+    uint64_t bucketMask;
+
+    /** @brief Round-robin victim when a bucket is full. */
+    unsigned int victim;
+
+    /** @brief How many results were evicted from the hashed table. */
+    uint64_t nbEvictions;
+};
+
+#endif
@@ -0,0 +1,279 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+#ifndef CHECK_CONTEXT_H_INCLUDED
+#define CHECK_CONTEXT_H_INCLUDED
+
+#include "Def.h"
+#include "CheckCache.h"
+#include "TaskPool.h"
+
+#include <string>
+
+class Term;
+
+/**
+ * \file CheckContext.h
+ * @brief Description of the struct CheckReason and of the class CheckContext.
+ *
+ * A CheckContext holds everything that one check of a formula writes while it runs,
+ * so several checks (or several threads of the same check) never share anything but the cache.
+ *
+ * @version 1.0
+ */
+
+/**
+ * \struct CheckReason
+ *
+ * @brief Why a check gave {KO,UNKNOWN}: the Term causing it, the Checking code @see Def.h and the world.
+ */
+struct CheckReason {
+
+    /** @brief The Term causing the {KO,UNKNOWN}. */
+    Term* node;
+
+    /** @brief The Checking code. */
+    unsigned int code;
+
+    /** @brief The world in which it happened. */
+    unsigned int world;
+};
+
+/**
+ * \class CheckContext
+ *
+ * @brief The state of one check: the reason of its result, its statistics, its cache and its cancellation.
+ *
+ * - the reason is the one of the last CheckContext::setReason, which explains a {KO,UNKNOWN} result;
+ * - the statistics count how many results were found in the cache, or not;
+ * - the cache can be shared by several contexts (see CheckCache::setShared);
+ * - with the parallel engine, the pool runs the tasks and the group tells if the result is still needed;
+ * - in the adaptive mode, the BooleanOperations reorder their children from what they observe (see BooleanOperation::checkBranch);
+ * - with the witnesses, a diamond checks first the successors where it found its last witnesses (see ModalOperation::checkDiamond).
+ *
+ * Each task of the parallel engine has its own context, which is given back to its parent once the task is finished.
+ */
+class CheckContext {
+
+public:
+
+    /**
+     * @brief To construct a context, we need the cache and, for the parallel engine, the pool and the group of the check.
+     *
+     * @param[in] cache the cache of the (sub-formula, world) results (NULL means no cache).
+     *
+     * @param[in] pool the threads which can share the work (NULL to check with the current thread only).
+     *
+     * @param[in] group the group of the current task (NULL if nothing can cancel the check).
+     */
+    CheckContext(CheckCache* cache = NULL, TaskPool* pool = NULL, TaskGroup* group = NULL) : cache(cache), pool(pool), group(group), nbHits(0), nbMisses(0), nbChecks(0), adaptive(false), witnesses(false) {
+      reason.node = NULL;
+      reason.code = NO_REASON_FOUND;
+      reason.world = 0;
+    }
+
+    /**
+     * @brief To construct the context of a task, we need the context which spawns it and the group of the task.
+     *
+     * @param[in] parent the context which spawns the task (the cache and the pool are the same).
+     *
+     * @param[in] group the group of the task.
+     */
+    CheckContext(const CheckContext & parent, TaskGroup & group) : CheckContext(parent.cache, parent.pool, &group) { }
+
+    /**
+     * @brief This method will set the Checking Code, a pointer to the Term causing this reason and the world in which it happened.
+     * 
+     * @param[in] t a pointer to the Term that cause the call of CheckContext::setReason
+     * 
+     * @param[in] c the Checking code set as the reason @see Def.h
+     * 
+     * @param[in] w the world in which the call of CheckContext::setReason happened.
+     */
+    void setReason(Term* t, unsigned int c, unsigned int w) { reason.node = t; reason.code = c; reason.world = w; }
+
+    /**
+     * @brief This method will set the reason found by another context (the task which decided the result).
+     * 
+     * @param[in] r the Term, the Checking code and the world.
+     */
+    void setReason(const CheckReason & r) { reason = r; }
+
+    /**
+     * @brief This method will return the reason of the last CheckContext::setReason.
+     * 
+     * @return the Term, the Checking code and the world.
+     */
+    const CheckReason & getReason() const { return reason; }
+
+    /**
+     * @brief according to the code stored and the pointer of the Term*, this method will return an adapted message.
+     * 
+     * @param[in] kripke the Kripke model which was checked (to give the worlds with their id in the solution).
+     *
+     * @return an adapted message according to the code and the Term* of the reason.
+     */
+    string getReasonUnchecked(Kripke & kripke) const;
+
+    /**
+     * @brief This method will return the stored result of the Term 'term' in the world 'world', and count it.
+     *
+     * A stored {KO,UNKNOWN} result has no reason: the reason becomes RESULT_FROM_CACHE (see CheckContext::explainCachedReason).
+     *
+     * @param[in] term the id of the Term.
+     *
+     * @param[in] world the world in which the Term was checked.
+     *
+     * @param[in] node the Term (only kept in the reason).
+     *
+     * @return {OK,KO,UNKNOWN} if the result is stored, NOT_YET otherwise (or if there is no cache).
+     */
+    inline unsigned int lookup(unsigned int term, unsigned int world, Term* node) {
+
+      unsigned int res = cache->lookup(term,world);
+
+      if(res == NOT_YET) nbMisses++;
+      else               nbHits++;
+
+      if(res == KO || res == UNKNOWN) setReason(node,RESULT_FROM_CACHE,world);
+
+      return res;
+    }
+
+    /**
+     * @brief This method will give its own reason to a {KO,UNKNOWN} result which was found in the cache.
+     *
+     * The Term of the reason is checked again in its world: its children are still in the cache, so each step goes down the formula,
+     * until the reason is the one that a check without cache would give.
+     *
+     * @param[in] kripke the Kripke model which was checked.
+     */
+    void explainCachedReason(Kripke & kripke);
+
+    /** @brief This method will count one more Term checked (by Term::check). */
+    inline void countCheck() { nbChecks++; }
+
+    /** @brief This method will return how many Terms were checked (by Term::check) with this context. */
+    uint64_t getNbChecks() const { return nbChecks; }
+
+    /**
+     * @brief This method will set the adaptive mode: the BooleanOperations reorder their children from the results and the work observed.
+     *
+     * @param[in] adaptive true to reorder the children while checking.
+     */
+    void setAdaptive(bool adaptive) { this->adaptive = adaptive; }
+
+    /**
+     * @brief This method will tell if the BooleanOperations can reorder their children.
+     *
+     * @return true in the adaptive mode, if the check is not shared by several threads.
+     *
+     * @note the counters and the order of the children are not protected, so the parallel engine always uses the static order
+     *       of the children: -a does nothing with '-e parallel'.
+     */
+    bool isAdaptive() const { return adaptive && pool == NULL; }
+
+    /**
+     * @brief This method will set if the diamonds check first the successors where they found their last witnesses.
+     *
+     * @param[in] witnesses true to check the last witnesses first.
+     */
+    void setWitnesses(bool witnesses) { this->witnesses = witnesses; }
+
+    /**
+     * @brief This method will tell if the diamonds check first the successors where they found their last witnesses.
+     *
+     * @return true if the witnesses are used, if the check is not shared by several threads.
+     *
+     * @note the witnesses are not protected, so the threads sharing a check always scan the successors in their order:
+     *       -d does nothing with '-e parallel'.
+     */
+    bool usesWitnesses() const { return witnesses && pool == NULL; }
+
+    /** @brief This method will return the cache of the check (NULL if there is none). */
+    CheckCache* getCache() const { return cache; }
+
+    /** @brief This method will return the threads which can share the work (NULL if there are none). */
+    TaskPool* getPool() const { return pool; }
+
+    /** @brief This method will return the group of the current task (NULL if nothing can cancel the check). */
+    TaskGroup* getGroup() const { return group; }
+
+    /**
+     * @brief This method will tell if the result of the check is not needed anymore.
+     *
+     * @return true if the group of the current task, or one of its parents, was cancelled.
+     */
+    bool isCancelled() const { return group != NULL && group->isCancelled(); }
+
+    /**
+     * @brief This method will add the statistics of another context (a finished task) to the ones of this context.
+     *
+     * @param[in] other the context of the finished task.
+     */
+    void addStatistics(const CheckContext & other) { nbHits += other.nbHits; nbMisses += other.nbMisses; }
+
+    /** @brief This method will return how many times a stored result was found. */
+    uint64_t getNbHits() const { return nbHits; }
+
+    /** @brief This method will return how many times a result was not stored (yet). */
+    uint64_t getNbMisses() const { return nbMisses; }
+
+    /**
+     * @brief This method will display the statistics of the check as comment lines.
+     *
+     * @param[in] f the FILE* in which we want to display the statistics.
+     */
+    void displayStatistics(FILE* f = stdout) const;
+
+private:
+
+    /** @brief The reason of the last {KO,UNKNOWN}. */
+    CheckReason reason;
+
+    /** @brief The cache of the (sub-formula, world) results (NULL means no cache). */
+    CheckCache* cache;
+
+    /** @brief The threads which can share the work (NULL to check with the current thread only). */
+    TaskPool* pool;
+
+    /** @brief The group of the current task (NULL if nothing can cancel the check). */
+    TaskGroup* group;
+
+    /** @brief How many times a stored result was found. */
+    uint64_t nbHits;
+
+    /** @brief How many times a result was not stored. */
+    uint64_t nbMisses;
+
+    /** @brief How many Terms were checked (the work done, to measure the cost of a child in the adaptive mode). */
+    uint64_t nbChecks;
+
+    /** @brief true if the BooleanOperations can reorder their children. */
+    bool adaptive;
+
+    /** @brief true if the diamonds check their last witnesses first. */
+    bool witnesses;
+};
+
+#endif
@@ -0,0 +1,114 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+#ifndef DECOMPRESSOR_H_INCLUDED
+#define DECOMPRESSOR_H_INCLUDED
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/**
+ * \file Decompressor.h
+ * @brief Description of the class Decompressor.
+ *
+ * A Decompressor recognizes a compressed input by its first bytes and decompresses it on its own thread.
+ *
+ * @version 1.0
+ */
+
+/**
+ * \enum compression_t
+ *
+ * @brief The formats recognized by their first bytes.
+ */
+enum compression_t {
+
+    C_NONE,     /*!< not compressed. */
+    C_GZIP,     /*!< gzip (1F 8B). */
+    C_XZ,       /*!< xz (FD '7zXZ' 00). */
+    C_ZSTD      /*!< zstd (28 B5 2F FD). */
+};
+
+/**
+ * \class Decompressor
+ *
+ * @brief A Decompressor gives a file descriptor from which the decompressed data can be read.
+ *
+ * The decompression runs on a detached thread, which writes into a pipe.
+ * So the decompression of a block overlaps with the parsing of the previous one.
+ *
+ * gzip uses zlib if the verifier is built with WITH_GZIP=1, xz uses liblzma with WITH_XZ=1 and zstd uses libzstd with WITH_ZSTD=1.
+ */
+class Decompressor {
+
+public:
+
+    /** @brief The number of bytes needed to recognize every format. */
+    static const size_t MAGIC_SIZE = 6;
+
+    /**
+     * @brief This method will recognize the format of some data by its first bytes.
+     *
+     * @param[in] data the first bytes.
+     *
+     * @param[in] size the number of bytes available (MAGIC_SIZE are enough).
+     *
+     * @return the format of the data, C_NONE if it is not compressed.
+     */
+    static compression_t detect(const char* data, size_t size);
+
+    /**
+     * @brief This method will start the decompression of the file descriptor 'fd' on a new thread.
+     *
+     * @param[in] fd the compressed input (the thread closes it at the end).
+     *
+     * @param[in] format the format of the input.
+     *
+     * @param[in] prefix the first bytes of the input, already read from fd.
+     *
+     * @param[in] prefixSize the number of bytes already read.
+     *
+     * @return the file descriptor from which the decompressed data can be read.
+     */
+    static int start(int fd, compression_t format, const char* prefix, size_t prefixSize);
+
+    /**
+     * @brief This method will open a file which may be compressed, to read it with the stdio functions.
+     *
+     * @param[in] path the path of the file.
+     *
+     * @return the FILE* of the (decompressed) data, NULL if the file can not be opened.
+     */
+    static FILE* openFile(const char* path);
+
+    /**
+     * @brief This method will return the name of a format.
+     *
+     * @param[in] format the format.
+     *
+     * @return "gzip", "xz", "zstd" or "none".
+     */
+    static const char* getName(compression_t format);
+};
+
+#endif
@@ -24,8 +24,6 @@
 #ifndef DEFINITIONS_H_INCLUDED
 #define DEFINITIONS_H_INCLUDED
 
-#include "Kripke.h"
-
 #include <map>
 
 /**
@@ -60,6 +58,51 @@ enum operator_t {
   /** @brief in order to sort Term. */
   O_DOESNT_EXIST
 }; 
+
+/**
+ * @brief We declare an enumerate type for the kinds of Term (to switch on it instead of a dynamic_cast).
+ */
+enum kind_t {
+
+  /** @brief a BooleanConstant */
+  K_CONSTANT = 0,
+
+  /** @brief a PropositionalVariable */
+  K_VARIABLE,
+
+  /** @brief a BooleanOperation */
+  K_BOOLEAN,
+
+  /** @brief a ModalOperation */
+  K_MODAL
+};
+
+/**
+ * @brief We declare an enumerate type for the engines which can check a formula.
+ */
+enum engine_t {
+
+  /** @brief top-down, from w0, with a recursive call per sub-formula */
+  E_RECURSIVE = 0,
+
+  /** @brief bottom-up, every sub-formula labeled in every world */
+  E_LABELING,
+
+  /** @brief top-down, from w0, the children and the successors shared by several threads */
+  E_PARALLEL,
+
+  /** @brief top-down, from w0, with an explicit stack instead of recursive calls */
+  E_ITERATIVE,
+
+  /** @brief top-down, from w0, the formula being compiled into an array of instructions */
+  E_BYTECODE,
+
+  /** @brief top-down, from w0, the formula being compiled into machine code by the compiler of the machine */
+  E_NATIVE,
+
+  /** @brief top-down, from w0, the formula being stored as parallel arrays */
+  E_STORE
+};
   
 /**
  * @brief In the Learning-Set, sometimes we don't know if we already check something. 
@@ -126,4 +169,13 @@ enum operator_t {
  */  
 #define UNKNOWN_AND_UNKNOWN              6
 
+/**
+ * @brief This value is not a reason to display: the {KO,UNKNOWN} result of the Term was found in the cache, 
+ * its reason is found again by CheckContext::explainCachedReason.
+ */
+#define RESULT_FROM_CACHE                7
+
+/* Kripke.h needs the values above, so it is included once they are defined. */
+#include "Kripke.h"
+
 #endif 
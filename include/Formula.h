@@ -101,27 +101,189 @@ class Formula {
        *
        * [r1]a ^ [r1]b <=> [r1](a ^ b) 
        *
-       * Then we will order children of each Term.
+       * Then we will order children of each Term, share the sub-formulae appearing several times, and compile the clauses of literals.
+       *
+       * @param[in] share false to keep every sub-formula as it is written (see Formula::shareSubformulas).
+       *
+       * @param[in] clauses false to check the clauses of literals child by child (see Formula::compileClauses).
+       */
+      void simplify(bool share = true, bool clauses = true);
+
+      /**
+       * @brief This method will make every sub-formula appearing several times one Term, shared by its fathers.
+       *
+       * Two Terms are equal if they have the same kind, polarity, operator (or atom) and the same children in the same order.
+       * The formula becomes a DAG: the father of a shared Term is only one of them.
+       *
+       * @return the number of Terms replaced by an equal one.
+       */
+      unsigned int shareSubformulas();
+
+      /**
+       * @brief This method will return the number of Terms replaced by an equal one by the last Formula::shareSubformulas.
+       *
+       * @return the number of Terms removed from the formula.
+       */
+      unsigned int getNbShared() { return nbShared; }
+
+      /**
+       * @brief This method will compile every BooleanOperation whose children are all literals into masks of the valuation rows.
+       *
+       * A clause (a cube) is then checked in a few word tests instead of one check per literal (see BooleanOperation::compileLiteralMasks),
+       * by the recursive and the parallel engines.
+       *
+       * @return the number of BooleanOperations compiled.
+       */
+      unsigned int compileClauses();
+
+      /**
+       * @brief This method will return the number of BooleanOperations compiled by the last Formula::compileClauses.
+       *
+       * @return the number of clauses and cubes of literals.
        */
-      void simplify();
+      unsigned int getNbCompiled() { return nbCompiled; }
+
+      /**
+       * @brief This method will sort the children of every BooleanOperation by their expected cost in the Kripke model.
+       *
+       * The probability that a literal is OK (KO) is the fraction of the worlds where it is (its opposite is) assigned,
+       * a modal operator checks the average number of successors, and a child is checked first if it is cheap and likely to stop the check.
+       *
+       * The result is the same, but the child which gives the reason of a {KO,UNKNOWN} result may change, so it is only done with -o.
+       *
+       * @param[in] kripke the Kripke model which will be checked.
+       */
+      void orderChildrenByCost(Kripke & kripke);
+
+      /**
+       * @brief This method will give an id to every Term of the formula (once to a shared Term).
+       *
+       * @return the number of Terms in the formula.
+       */
+      unsigned int setTermIds();
+
+      /**
+       * @brief This method will return the modal depth of the formula (the worlds further from w0 can not change its result).
+       *
+       * @return the modal depth of the root.
+       */
+      unsigned int getModalDepth() { return (root != NULL) ? root->getModalDepth() : 0; }
 
       /**
        * @brief This method will check the formula according to a Kripke model.
        *
        * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
        *
+       * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+       *
+       * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+       */
+      unsigned int checkFormula(Kripke & kripke, CheckContext & context);
+
+      /**
+       * @brief This method will check the formula according to a Kripke model, by labeling every world bottom-up.
+       *
+       * Every sub-formula is labeled {OK,KO,UNKNOWN} in every world, from the leaves to the root.
+       * It takes O(|formula| x (|Worlds| + |Edges|)) time, whatever the shape of the Kripke model.
+       * The reason of a {KO,UNKNOWN} result is the one of checkBranch in w0, which reads the labels stored in the cache.
+       *
+       * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+       *
+       * @param[in,out] context the context of the check (the reason of a {KO,UNKNOWN} result).
+       *
+       * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+       */
+      unsigned int checkFormulaByLabeling(Kripke & kripke, CheckContext & context);
+
+      /**
+       * @brief This method will check the formula according to a Kripke model, top-down, with several threads.
+       *
+       * The children of a BooleanOperation and the successors of a ModalOperation are checked by tasks,
+       * which the threads steal from each other, and a decisive result cancels the tasks which are not needed anymore.
+       *
+       * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+       *
+       * @param[in] nbThreads the number of threads (the calling one included).
+       *
+       * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+       *
+       * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+       */
+      unsigned int checkFormulaInParallel(Kripke & kripke, unsigned int nbThreads, CheckContext & context);
+
+      /**
+       * @brief This method will check the formula according to a Kripke model, top-down, without any recursive call.
+       *
+       * Same results as checkFormula, but the Operations being checked are frames of a stack stored in the heap (see IterativeChecker),
+       * so a formula with a very large modal depth can not overflow the native stack.
+       *
+       * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+       *
+       * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+       *
        * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
        */
-      unsigned int checkFormula(Kripke & kripke);
+      unsigned int checkFormulaIteratively(Kripke & kripke, CheckContext & context);
+
+      /**
+       * @brief This method will check the formula according to a Kripke model, top-down, once compiled into an array of instructions.
+       *
+       * Same results as checkFormula, but the interpreter of the Bytecode has no virtual call and reads the formula contiguously.
+       *
+       * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+       *
+       * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+       *
+       * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+       */
+      unsigned int checkFormulaCompiled(Kripke & kripke, CheckContext & context);
+
+      /**
+       * @brief This method will check the formula according to a Kripke model, top-down, once compiled into machine code.
+       *
+       * Same results as checkFormula, the formula being translated into C++ and built into a shared object (see NativeChecker).
+       * If the shared object can not be built, the formula is checked by the Bytecode.
+       *
+       * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+       *
+       * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+       *
+       * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+       */
+      unsigned int checkFormulaNatively(Kripke & kripke, CheckContext & context);
+
+      /**
+       * @brief This method will check the formula according to a Kripke model, top-down, once stored as a struct of arrays.
+       *
+       * Same results as checkFormula, the nodes being read from the arrays of a FormulaStore (Formula::setTermIds has to be called before).
+       *
+       * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+       *
+       * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+       *
+       * @param[in] verbose true to display the size of the store.
+       *
+       * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+       */
+      unsigned int checkFormulaFromStore(Kripke & kripke, CheckContext & context, bool verbose = false);
 
 	private:
 
     /** @brief The constructor is private, and to construct a formula, we just put the root as NULL; */
-    Formula() { root = NULL; }
+    Formula() { root = NULL; nbTerms = 0; nbShared = 0; nbCompiled = 0; }
 
     /** @brief a Formula is a tree, so we need a Root. */
     Term* root;
 
+    /** @brief The number of ids given by Formula::setTermIds. */
+    unsigned int nbTerms;
+
+    /** @brief The number of Terms replaced by an equal one (see Formula::shareSubformulas). */
+    unsigned int nbShared;
+
+    /** @brief The number of BooleanOperations compiled into masks (see Formula::compileClauses). */
+    unsigned int nbCompiled;
+
 		/** @brief Static instance of formula (Singleton pattern) */
   	static Formula* instance;
   
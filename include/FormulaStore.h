@@ -0,0 +1,177 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+#ifndef FORMULA_STORE_H_INCLUDED
+#define FORMULA_STORE_H_INCLUDED
+
+#include "Term.h"
+
+#include <stdint.h>
+
+/**
+ * \file FormulaStore.h
+ * @brief Description of the class FormulaStore.
+ *
+ * A FormulaStore is the simplified formula as parallel arrays indexed by the ids of the Terms (see Term::setTermIds),
+ * the children of every Operation being a range of one shared array of ids.
+ *
+ * @version 1.0
+ */
+
+/**
+ * \class FormulaStore
+ *
+ * @brief The formula as a struct of arrays, and a checker which switches on the kind of each node.
+ *
+ * For the node n (the Term of id n):
+ *
+ * - kinds[n] is its kind_t, operators[n] its operator_t (O_DOESNT_EXIST for a leaf) and negated[n] the polarity of a literal;
+ * - operands[n] is the variable of a literal, the value of a constant, or the first child of an Operation in 'children';
+ * - nbChildren[n] and chainSizes[n] are the ones of the Term.
+ *
+ * A node takes 15 bytes (and the pointer to its Term), and 4 more bytes per child. The results, the short-circuits, the use of the cache and the
+ * reasons of FormulaStore::check are exactly the ones of Term::check; the Terms are only kept to give the reasons.
+ */
+class FormulaStore {
+
+public:
+
+    /**
+     * @brief To construct a FormulaStore, we need the root of the simplified formula and the number of ids given.
+     *
+     * @param[in] root the root of the formula (with its chains and its ids).
+     *
+     * @param[in] nbTerms the number of ids given by Term::setTermIds.
+     */
+    FormulaStore(Term* root, unsigned int nbTerms);
+
+    /**
+     * @brief This method will check if the formula is {OK,KO,UNKNOWN} in the world w.
+     *
+     * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+     *
+     * @param[in] w the world in which we are checking the satisfiability of the formula.
+     *
+     * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+     *
+     * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the formula.
+     */
+    unsigned int check(Kripke & kripke, unsigned int w, CheckContext & context) const;
+
+    /**
+     * @brief This method will return the number of nodes.
+     *
+     * @return the number of Terms in the formula.
+     */
+    size_t size() const { return kinds.size(); }
+
+    /**
+     * @brief This method will return the memory used by the arrays (without the Terms kept for the reasons).
+     *
+     * @return the number of bytes of the store.
+     */
+    size_t getMemory() const;
+
+private:
+
+    /**
+     * @brief This method will fill the arrays for a Term and its sub-formulae.
+     *
+     * @param[in] term the Term to store.
+     */
+    void add(Term* term);
+
+    /**
+     * @brief This method will check the node n, which has no children, in the world w.
+     *
+     * @param[in] n the id of the node.
+     *
+     * @param[in] w the world in which the node is checked.
+     *
+     * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+     *
+     * @param[in,out] context the context of the check.
+     *
+     * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the node.
+     */
+    inline unsigned int runLeaf(uint32_t n, unsigned int w, Kripke & kripke, CheckContext & context) const;
+
+    /**
+     * @brief This method will check the node n in the world w.
+     *
+     * @param[in] n the id of the node.
+     *
+     * @param[in] w the world in which the node is checked.
+     *
+     * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+     *
+     * @param[in,out] context the context of the check.
+     *
+     * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the node.
+     */
+    inline unsigned int run(uint32_t n, unsigned int w, Kripke & kripke, CheckContext & context) const;
+
+    /**
+     * @brief This method will check the node n of an Operation in the world w (the cache was already looked at).
+     *
+     * @param[in] n the id of the node.
+     *
+     * @param[in] w the world in which the node is checked.
+     *
+     * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+     *
+     * @param[in,out] context the context of the check.
+     *
+     * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the node.
+     */
+    unsigned int runOperation(uint32_t n, unsigned int w, Kripke & kripke, CheckContext & context) const;
+
+    /** @brief The kind_t of each node. */
+    vector<uint8_t> kinds;
+
+    /** @brief The operator_t of each node (O_DOESNT_EXIST for a leaf). */
+    vector<uint8_t> operators;
+
+    /** @brief 1 if the node is a negated literal. */
+    vector<uint8_t> negated;
+
+    /** @brief The variable of a literal, the value of a constant, the first child of an Operation. */
+    vector<uint32_t> operands;
+
+    /** @brief The number of children of each node. */
+    vector<uint32_t> nbChildren;
+
+    /** @brief The chain of modal operators of each node (see Term::getModalTermChainSize). */
+    vector<uint32_t> chainSizes;
+
+    /** @brief The children of every Operation, one range per Operation. */
+    vector<uint32_t> children;
+
+    /** @brief The Term of each node (only to give the reasons). */
+    vector<Term*> terms;
+
+    /** @brief The id of the root. */
+    uint32_t root;
+};
+
+#endif
@@ -0,0 +1,159 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+#ifndef ITERATIVE_CHECKER_H_INCLUDED
+#define ITERATIVE_CHECKER_H_INCLUDED
+
+#include "BooleanOperation.h"
+#include "ModalOperation.h"
+
+/**
+ * \file IterativeChecker.h
+ * @brief Description of the class IterativeChecker.
+ *
+ * An IterativeChecker checks a formula top-down like Term::check, but without any recursive call:
+ * the Operations being checked are frames of a stack stored in the heap, so the depth of the formula is not limited by the native stack.
+ *
+ * @version 1.0
+ */
+
+/**
+ * \class IterativeChecker
+ *
+ * @brief Checks a Term in a world with an explicit stack of frames, one per Operation being checked.
+ *
+ * The results, the short-circuits and the reasons are exactly the ones of Term::check:
+ *
+ * - an OR stops at the first OK child, an AND at the first KO child;
+ * - a diamond stops at the first OK successor, a box at the first successor which is not OK;
+ * - a Term without children is checked directly, an Operation is looked for in the cache before a frame is pushed,
+ *   and its result is stored in the cache when its frame is popped.
+ *
+ * The frames are 32 bytes, contiguous in one vector which is kept from one check to the next.
+ */
+class IterativeChecker {
+
+public:
+
+    /**
+     * @brief To construct a checker, we need the Kripke model and the context of the check.
+     *
+     * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+     *
+     * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+     */
+    IterativeChecker(Kripke & kripke, CheckContext & context) : kripke(kripke), context(context) { }
+
+    /**
+     * @brief This method will check if the Term is {OK,KO,UNKNOWN} in the world w.
+     *
+     * @param[in] term the Term to check.
+     *
+     * @param[in] w the world in which we are checking the satisfiability of the Term.
+     *
+     * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the Term.
+     */
+    unsigned int check(Term* term, unsigned int w);
+
+private:
+
+    /**
+     * \struct Frame
+     *
+     * @brief An Operation being checked: which child (or which successor) is the next one, and what its children gave so far.
+     */
+    struct Frame {
+
+        /** @brief The Operation being checked. */
+        Term* node;
+
+        /** @brief For a ModalOperation, the sub-formula checked in the successors (at the end of the chain). */
+        Term* sub;
+
+        /** @brief The world in which the Operation is checked (its result is stored in the cache for this world). */
+        unsigned int world;
+
+        /** @brief The world whose successors are checked (after the chain of worlds for a ModalOperation, world otherwise). */
+        unsigned int at;
+
+        /** @brief The index of the next child (or of the next successor) to check. */
+        unsigned int next;
+
+        /** @brief The operator of the Operation (an operator_t). */
+        unsigned char op;
+
+        /** @brief NO_UNKNOWN and NO_KO, for a BooleanOperation. */
+        unsigned char flags;
+    };
+
+    /** @brief In a frame, no child was UNKNOWN (so far). */
+    static const unsigned char NO_UNKNOWN = 1;
+
+    /** @brief In a frame, no child was KO (so far). */
+    static const unsigned char NO_KO = 2;
+
+    /**
+     * @brief This method will start the check of a Term in a world.
+     *
+     * @param[in] term the Term to check.
+     *
+     * @param[in] w the world in which the Term is checked.
+     *
+     * @return {OK,KO,UNKNOWN} if the result is already known (a Term without children, or a result in the cache),
+     *         NOT_YET if a frame was pushed for the Term.
+     */
+    unsigned int enter(Term* term, unsigned int w);
+
+    /**
+     * @brief This method will go on with the check of a BooleanOperation, as far as it can without a new frame.
+     *
+     * @param[in,out] f the frame of the BooleanOperation (it can not be used anymore if a frame is pushed).
+     *
+     * @param[in] res the result of the last child entered (NOT_YET if the frame was just pushed).
+     *
+     * @return {OK,KO,UNKNOWN} the result of the BooleanOperation, NOT_YET if a frame was pushed for one of its children.
+     */
+    unsigned int stepBoolean(Frame & f, unsigned int res);
+
+    /**
+     * @brief This method will go on with the check of a ModalOperation, as far as it can without a new frame.
+     *
+     * @param[in,out] f the frame of the ModalOperation (it can not be used anymore if a frame is pushed).
+     *
+     * @param[in] res the result of the sub-formula in the last successor entered (NOT_YET if the frame was just pushed).
+     *
+     * @return {OK,KO,UNKNOWN} the result of the ModalOperation, NOT_YET if a frame was pushed for the sub-formula.
+     */
+    unsigned int stepModal(Frame & f, unsigned int res);
+
+    /** @brief The Kripke model which is (or not) the solution of the formula. */
+    Kripke & kripke;
+
+    /** @brief The context of the check. */
+    CheckContext & context;
+
+    /** @brief The frames of the Operations being checked, the last one at the top. */
+    vector<Frame> frames;
+};
+
+#endif
@@ -33,6 +33,7 @@
 #include <cstring>
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 #include "Def.h"
 
@@ -51,6 +52,32 @@ class Term;
 
 using namespace std;
 
+/**
+ * \struct WorldSpan
+ *
+ * @brief A read-only view on the worlds accessible from one world (a slice of the CSR edges of a Kripke model).
+ */
+struct WorldSpan {
+
+    /** @brief The first accessible world. */
+    const unsigned int* first;
+
+    /** @brief After the last accessible world. */
+    const unsigned int* last;
+
+    /** @brief The number of accessible worlds. */
+    unsigned int size() const { return last - first; }
+
+    /** @brief The i-th accessible world. */
+    unsigned int operator[](unsigned int i) const { return first[i]; }
+
+    /** @brief To iterate over the accessible worlds. */
+    const unsigned int* begin() const { return first; }
+
+    /** @brief To iterate over the accessible worlds. */
+    const unsigned int* end() const { return last; }
+};
+
 /**
  * \class Kripke
  *
@@ -63,12 +90,15 @@ public:
     /** 
      * @brief The default constructor will just initiliaze everything to 0 and NULL. 
      */
-    Kripke() { num_worlds = 0; num_variables = 0; edges = NULL; }
+    Kripke() {
+      num_worlds = 0; declaredWorlds = 0; num_variables = 0; rowWords = 0; nbTransposedVariables = 0; wordsPerVariable = 0;
+      valuationData = NULL; offsetData = NULL; targetData = NULL; binaryData = NULL; binarySize = 0; binaryMapped = false;
+    }
 
-    /** 
-     * @brief This method is the destructor, it will just delete all the edges stored. 
+    /**
+     * @brief This method is the destructor, it will release the binary model (if any).
      */
-	~Kripke() { if(edges != NULL) { for(unsigned int i =0; i < num_worlds; i++) delete edges[i]; free(edges); edges = NULL; } }
+    ~Kripke();
 
     /**
      * @brief This method will assigned the atom 'value' in the world 'world'.
@@ -77,7 +107,22 @@ public:
      *
      * @param[in] world the world in which the atom is assigned.
      */
-    void assignValue(int value, unsigned int world);
+    inline void assignValue(int value, unsigned int world) {
+
+      unsigned int abs_value = abs(value);
+
+      if(value == 0) return;
+
+      /* If the atom does not fit in a row, every row becomes larger. */
+      if(abs_value > rowWords * VARIABLES_PER_WORD) growRows(abs_value);
+
+      uint64_t & word = valuations[(size_t) world * rowWords + (abs_value-1) / VARIABLES_PER_WORD];
+      unsigned int shift = ((abs_value-1) % VARIABLES_PER_WORD) << 1;
+
+      /* If we want to assign p'value' positevely, we just put 01 in [world][value-1] */
+      /* If we want to assign p'value' negatively, we just put 10 in [world][value-1] */
+      word = (word & ~((uint64_t) 3 << shift)) | ((uint64_t) (1 + (value < 0)) << shift);
+    }
 
     /**
      * @brief This method will add an edge between w1 --> w2.
@@ -85,15 +130,133 @@ public:
      * @param[in] w1 the starting world
      * 
      * @param[in] w2 the arrival world.
+     *
+     * @note the edge is pending until Kripke::buildEdges is called.
+     */
+    void addEdge(unsigned int w1, unsigned int w2) { pendingEdges.push_back(w1); pendingEdges.push_back(w2); }
+
+    /**
+     * @brief This method will make room for n pending edges, to be filled by the caller.
+     *
+     * @param[in] n the number of edges.
+     *
+     * @return where to write the n pairs (w1,w2).
+     *
+     * @note it allows several threads to copy their edges at the same time, each one at its own place.
+     */
+    unsigned int* reserveEdges(size_t n) { size_t old = pendingEdges.size(); pendingEdges.resize(old + 2 * n); return &pendingEdges[0] + old; }
+
+    /**
+     * @brief This method will store all the pending edges in the CSR arrays (edgeOffsets and edgeTargets).
+     *
+     * It is a counting sort in 2 passes: first we count the edges of each world, then we put each target at its place.
+     * The order of the edges of a world is kept.
      */
-    void addEdge(unsigned int w1, unsigned int w2) { edges[w1]->push_back(w2); }
+    void buildEdges();
+
+    /**
+     * @brief This method will set the size of the model, before any assignation or edge is added.
+     *
+     * @param[in] nbVariables the number of propositional variables.
+     *
+     * @param[in] nbWorlds the number of worlds.
+     *
+     * @param[in] nbEdges the number of edges (only to reserve the memory).
+     *
+     * @param[in] withValuations false if the valuation matrix is only allocated by Kripke::pruneUnreachable (the rows are parsed after it).
+     */
+    void initialize(unsigned int nbVariables, unsigned int nbWorlds, size_t nbEdges, bool withValuations = true);
 
     /**
      * @brief This method will parse the Kripke-CNF solution on the STDIN.
      *
-     * @note the reading is mandatory in STDIN.
+     * @param[in] depth the modal depth of the formula, the worlds further from w0 are not kept (NO_PRUNING to keep everything).
+     *
+     * @note the whole model is read before it is pruned, only a mapped file is pruned while it is parsed.
+     *
+     * @see KripkeReader
      */
-    void parseSolutionFile();
+    void parseSolutionFile(unsigned int depth = NO_PRUNING);
+
+    /**
+     * @brief This method will parse the Kripke-CNF solution in the file 'path'.
+     *
+     * @param[in] path the path of the solution (a regular file is mapped in memory, anything else is read as a stream).
+     *
+     * @param[in] nbThreads how many threads can parse a mapped file at the same time.
+     *
+     * @param[in] depth the modal depth of the formula, the worlds further from w0 are not kept (NO_PRUNING to keep everything).
+     *
+     * @see KripkeReader
+     */
+    void parseSolutionFile(const char* path, unsigned int nbThreads = 1, unsigned int depth = NO_PRUNING);
+
+    /**
+     * @brief This method will keep only the worlds at distance at most 'depth' from w0, and the edges leaving the worlds at distance less than 'depth'.
+     *
+     * A formula of modal depth 'depth' checked in w0 can not see anything else, so its result does not change.
+     * The worlds kept are numbered in their original order (w0 stays w0), see Kripke::getOriginalId.
+     *
+     * @param[in] depth the modal depth of the formula.
+     *
+     * @note if the valuation matrix was not allocated (see Kripke::initialize), the rows of the worlds kept are allocated, empty.
+     */
+    void pruneUnreachable(unsigned int depth);
+
+    /**
+     * @brief This method will replace every world by the class of the worlds which are bisimilar to it (the quotient model).
+     *
+     * Two worlds are in the same class if they have the same valuation and their successors are in the same classes,
+     * in the same order once only the first successor of each class is kept (BOX gives the result of the first successor which is not OK).
+     * The classes are refined (partition refinement) until they are stable, or 'depth' times:
+     * a formula of modal depth 'depth' can not tell apart the worlds which are still in the same class.
+     *
+     * A class is numbered by its first world (w0 stays w0), see Kripke::getOriginalId.
+     *
+     * @param[in] depth the modal depth of the formula (NO_PRUNING for a model which is right for every formula).
+     */
+    void reduceBisimilar(unsigned int depth);
+
+    /**
+     * @brief This method will use a binary model (see Kripke::writeBinary) as it is in memory, without any copy.
+     *
+     * The model is checked once (sizes, rows wide enough for its variables, increasing offsets, targets which are worlds),
+     * so a truncated or corrupted file is rejected before any engine reads it.
+     *
+     * @param[in] data the binary model (the Kripke model takes its ownership).
+     *
+     * @param[in] size the number of bytes of data.
+     *
+     * @param[in] mapped true if data is a mapping of the file (released by munmap), false if it was allocated by malloc.
+     */
+    void loadBinary(const char* data, size_t size, bool mapped);
+
+    /**
+     * @brief This method will write the model in the binary format, which can then be given instead of the Kripke-CNF solution.
+     *
+     * The file is made of (in the byte order of the machine):
+     *
+     * - "MDKB", the version (uint32), nbVariables (uint32), nbWorlds (uint32), nbEdges (uint64), rowWords (uint64);
+     * - the valuation matrix, nbWorlds rows of rowWords uint64;
+     * - the offsets of the edges, nbWorlds+1 uint64;
+     * - the targets of the edges, nbEdges uint32.
+     *
+     * Every part starts on 8 bytes, so the file can be used directly once mapped.
+     *
+     * @param[in] path the path of the binary model.
+     */
+    void writeBinary(const char* path);
+
+    /**
+     * @brief This method will tell if some data starts like a binary model.
+     *
+     * @param[in] data the first bytes.
+     *
+     * @param[in] size the number of bytes available.
+     *
+     * @return true if data starts with the magic of the binary format.
+     */
+    static bool isBinary(const char* data, size_t size) { return size >= 4 && !memcmp(data, BINARY_MAGIC, 4); }
 
     /** 
      * @brief This method is returning the assignation of the variable 'value' in the world 'world'
@@ -102,20 +265,69 @@ public:
      *
      * @param[in] value the ID of the atom from which we want the assignation.
      * 
-     * @return the assignation of [world][value]
+     * @return the assignation of [world][value]: 1, -1, or 0 if the atom is not assigned.
      *
      * @note it's in fact [world][value-1]. P0 doesn't exist, so P1 is stored at [world][0].
      */
-    inline char getAssignedValue(unsigned int world,int value) { return assignations[world][value-1]; }
+    inline char getAssignedValue(unsigned int world,int value) {
+      static const char values[4] = { 0, 1, -1, 0 };
+      return values[getCell(world,value)];
+    }
+
+    /** 
+     * @brief This method will check a literal in the world 'world'.
+     * 
+     * @param[in] world the world that we are checking.
+     *
+     * @param[in] value the ID of the atom.
+     *
+     * @param[in] negated true if we are checking ~p'value', false if we are checking p'value'.
+     * 
+     * @return OK if the literal is assigned, KO if its opposite is assigned, UNKNOWN otherwise.
+     */
+    inline unsigned int checkLiteral(unsigned int world, unsigned int value, bool negated) {
+      static const unsigned char results[2][4] = { { UNKNOWN, OK, KO, UNKNOWN }, { UNKNOWN, KO, OK, UNKNOWN } };
+      return results[negated][getCell(world,value)];
+    }
+
+    /**
+     * @brief This method will return the packed assignations of the world 'world'.
+     *
+     * The variable p'v' is at the bits 2(v-1) (assigned positively) and 2(v-1)+1 (assigned negatively).
+     *
+     * @param[in] world the world that we want.
+     *
+     * @return the getRowWords() words of the assignations of 'world'.
+     */
+    inline const uint64_t* getRow(unsigned int world) { return valuationData + (size_t) world * rowWords; }
+
+    /**
+     * @brief This method will return how many variables fit in a row without making the rows larger.
+     *
+     * @return the number of variables that Kripke::assignValue can assign without moving the valuation matrix.
+     *
+     * @note as long as the atoms fit, several threads can assign values at the same time, in different worlds.
+     */
+    inline unsigned int getNbVariablesInRows() { return rowWords * VARIABLES_PER_WORD; }
+
+    /**
+     * @brief This method will return the number of 64-bit words of the assignations of a world.
+     *
+     * @return the number of 64-bit words in a row of the valuation matrix.
+     */
+    inline size_t getRowWords() { return rowWords; }
 
     /**
      * @brief This method is returning the list of worlds accessible from 'world'.
      * 
      * @param[in] world the ID of the world from which we want all the accessible one.
      * 
-     * @return all the accessible worlds from 'world' in a vector.
+     * @return all the accessible worlds from 'world' as a span in the CSR edges.
      */
-    vector<unsigned int>* getConnectedWorlds(unsigned int world) { return (this->edges[world]); }
+    WorldSpan getConnectedWorlds(unsigned int world) {
+      WorldSpan span = { targetData + offsetData[world], targetData + offsetData[world+1] };
+      return span;
+    }
 
     
     /**
@@ -125,7 +337,7 @@ public:
      *
      * @return the number of connected worlds from 'world'.
      */
-    unsigned int getNbConnectedWorlds(unsigned int world) { return (this->edges[world])->size(); }
+    unsigned int getNbConnectedWorlds(unsigned int world) { return offsetData[world+1] - offsetData[world]; }
 
     /**
      * @brief This method will return the "next world" attached to world in parameter.
@@ -134,7 +346,136 @@ public:
      * 
      * @note This method should be called only to get fastly a chain of world (when there is only 1 next world possible.)
      */
-    unsigned int nextWorld(unsigned int world) { return (*this->edges[world])[0]; }
+    unsigned int nextWorld(unsigned int world) { return targetData[offsetData[world]]; }
+
+    /**
+     * @brief This method is returning the list of worlds from which 'world' is accessible.
+     *
+     * @param[in] world the ID of the world from which we want all the predecessors.
+     *
+     * @return all the worlds connected to 'world', as a span in the reverse CSR edges (in increasing order).
+     *
+     * @note the reverse edges are built at the first call.
+     */
+    WorldSpan getPredecessors(unsigned int world) {
+      buildPredecessors();
+      WorldSpan span = { &predecessorTargets[0] + predecessorOffsets[world], &predecessorTargets[0] + predecessorOffsets[world+1] };
+      return span;
+    }
+
+    /**
+     * @brief This method will return the number of worlds from which 'world' is accessible.
+     *
+     * @param[in] world the id of the world.
+     *
+     * @return the number of predecessors of 'world'.
+     *
+     * @note the reverse edges are built at the first call.
+     */
+    unsigned int getNbPredecessors(unsigned int world) { buildPredecessors(); return predecessorOffsets[world+1] - predecessorOffsets[world]; }
+
+    /**
+     * @brief This method will tell if there is an edge from 'from' to 'to', by a binary search in the predecessors of 'to'.
+     *
+     * @param[in] from the starting world.
+     *
+     * @param[in] to the arrival world.
+     *
+     * @return true if 'to' is accessible from 'from'.
+     *
+     * @note the reverse edges are built at the first call.
+     */
+    bool isConnected(unsigned int from, unsigned int to) { WorldSpan span = getPredecessors(to); return std::binary_search(span.begin(),span.end(),from); }
+
+    /**
+     * @brief This method will return the number of edges in the current Kripke model.
+     *
+     * @return the number of edges.
+     */
+    size_t getNbEdges() { return (num_worlds > 0) ? offsetData[num_worlds] : 0; }
+
+    /**
+     * @brief This method will return the worlds in which the variable 'value' is assigned positively.
+     *
+     * @param[in] value the ID of the atom.
+     *
+     * @return a bitset of (getNbWorlds()+63)/64 words, the bit w is set if [w][value] is 1.
+     *
+     * @note the assignations are transposed (one bitset per variable) at the first call.
+     */
+    const uint64_t* getWorldsWhereTrue(unsigned int value) { transposeAssignations(); return worldsOf(worldsWhereTrue,value); }
+
+    /**
+     * @brief This method will return the worlds in which the variable 'value' is assigned negatively.
+     *
+     * @param[in] value the ID of the atom.
+     *
+     * @return a bitset of (getNbWorlds()+63)/64 words, the bit w is set if [w][value] is -1.
+     *
+     * @note the assignations are transposed (one bitset per variable) at the first call.
+     */
+    const uint64_t* getWorldsWhereFalse(unsigned int value) { transposeAssignations(); return worldsOf(worldsWhereFalse,value); }
+
+    /**
+     * @brief This method will count, for every atom, in how many worlds it is assigned positively and negatively.
+     *
+     * @param[out] nbTrue nbTrue[v] is the number of worlds where p'v' is assigned positively (nbTrue[0] is not used).
+     *
+     * @param[out] nbFalse nbFalse[v] is the number of worlds where p'v' is assigned negatively.
+     *
+     * @note the atoms which are not in the model are not in the vectors.
+     */
+    void countAssignations(vector<unsigned int> & nbTrue, vector<unsigned int> & nbFalse);
+
+    /**
+     * @brief This method will build, for every world, the AND and the OR of the rows of its successors.
+     *
+     * Then [r1]l and &lt;r1&gt;l, l a literal, are read in one word (see Kripke::isOKInEverySuccessor and Kripke::isOKInSomeSuccessor).
+     *
+     * @note it has to be called once the model is not changed anymore (the aggregates are removed when the worlds change).
+     */
+    void aggregateSuccessors();
+
+    /**
+     * @brief This method will tell if the aggregates of the successors were built.
+     *
+     * @return true once Kripke::aggregateSuccessors was called on the current worlds.
+     */
+    bool hasSuccessorAggregates() { return !everySuccessor.empty(); }
+
+    /**
+     * @brief This method will tell if a literal is assigned in every successor of the world 'world' (Kripke::aggregateSuccessors has to be called before).
+     *
+     * @param[in] world the world whose successors are read.
+     *
+     * @param[in] value the ID of the atom.
+     *
+     * @param[in] negated true for ~p'value', false for p'value'.
+     *
+     * @return true if checkLiteral is OK in every successor (a world without successor included).
+     */
+    inline bool isOKInEverySuccessor(unsigned int world, unsigned int value, bool negated) {
+      unsigned int v = value - 1;
+      if(v >= rowWords * VARIABLES_PER_WORD) return getNbConnectedWorlds(world) == 0;
+      return (everySuccessor[(size_t) world * rowWords + v / VARIABLES_PER_WORD] >> (((v % VARIABLES_PER_WORD) << 1) + negated)) & 1;
+    }
+
+    /**
+     * @brief This method will tell if a literal is assigned in a successor of the world 'world' (Kripke::aggregateSuccessors has to be called before).
+     *
+     * @param[in] world the world whose successors are read.
+     *
+     * @param[in] value the ID of the atom.
+     *
+     * @param[in] negated true for ~p'value', false for p'value'.
+     *
+     * @return true if checkLiteral is OK in at least one successor.
+     */
+    inline bool isOKInSomeSuccessor(unsigned int world, unsigned int value, bool negated) {
+      unsigned int v = value - 1;
+      if(v >= rowWords * VARIABLES_PER_WORD) return false;
+      return (someSuccessor[(size_t) world * rowWords + v / VARIABLES_PER_WORD] >> (((v % VARIABLES_PER_WORD) << 1) + negated)) & 1;
+    }
 
     /**
      * @brief This method will return the number of worlds in the current Kripke model.
@@ -143,19 +484,167 @@ public:
      */
     unsigned int getNbWorlds() { return num_worlds; }
 
+    /**
+     * @brief This method will return the number of worlds given by the solution (before Kripke::pruneUnreachable).
+     *
+     * @return the number of worlds in the solution.
+     */
+    unsigned int getNbDeclaredWorlds() { return declaredWorlds; }
+
+    /**
+     * @brief This method will return the id that the world 'world' has in the solution.
+     *
+     * @param[in] world the id of the world in the current Kripke model.
+     *
+     * @return its id in the solution (the same if nothing was pruned).
+     */
+    unsigned int getOriginalId(unsigned int world) { return originalIds.empty() ? world : originalIds[world]; }
+
+    /** @brief The depth given to keep every world. */
+    static const unsigned int NO_PRUNING = ~0u;
+
+    /** @brief How many variables fit in a 64-bit word of the valuation matrix (2 bits per variable). */
+    static const unsigned int VARIABLES_PER_WORD = 32;
+
 private:
 
+    /**
+     * @brief This method will return the 2 bits of the atom 'value' in the world 'world'.
+     *
+     * @param[in] world the world that we are checking.
+     *
+     * @param[in] value the ID of the atom.
+     *
+     * @return 0 if not assigned, 1 if assigned positively, 2 if assigned negatively.
+     */
+    inline unsigned int getCell(unsigned int world, unsigned int value) {
+      unsigned int v = value - 1;
+      if(v >= rowWords * VARIABLES_PER_WORD) return 0;
+      return (valuationData[(size_t) world * rowWords + v / VARIABLES_PER_WORD] >> ((v % VARIABLES_PER_WORD) << 1)) & 3;
+    }
+
+    /**
+     * @brief This method will make every row of the valuation matrix large enough for the atom 'value'.
+     *
+     * @param[in] value the atom that does not fit in a row.
+     */
+    void growRows(unsigned int value);
+
+    /**
+     * @brief This method will use the given arrays as the model (they are swapped with the ones of the model).
+     *
+     * @param[in,out] rows the valuation matrix.
+     *
+     * @param[in,out] offsets the offsets of the edges.
+     *
+     * @param[in,out] targets the targets of the edges.
+     *
+     * @param[in,out] ids the id in the solution of each world.
+     */
+    void replaceModel(vector<uint64_t> & rows, vector<uint64_t> & offsets, vector<unsigned int> & targets, vector<unsigned int> & ids);
+
+    /**
+     * @brief This method will build, once, the bitsets of the worlds where each variable is true and false.
+     */
+    void transposeAssignations();
+
+    /**
+     * @brief This method will build, once, the reverse CSR edges (the predecessors of each world).
+     */
+    void buildPredecessors() { if(predecessorOffsets.empty()) reverseEdges(); }
+
+    /**
+     * @brief This method will build the reverse CSR edges, by a counting sort of the edges on their arrival world.
+     */
+    void reverseEdges();
+
+    /**
+     * @brief This method will return the bitset of the variable 'value' in a transposed matrix.
+     *
+     * @param[in] matrix worldsWhereTrue or worldsWhereFalse.
+     *
+     * @param[in] value the ID of the atom (an atom which is not in the model has an empty bitset).
+     */
+    const uint64_t* worldsOf(vector<uint64_t> & matrix, unsigned int value) {
+      if(value == 0 || value > nbTransposedVariables) value = 0;
+      return &matrix[(size_t) value * wordsPerVariable];
+    }
+
 	/** @brief How many propositional variables there are in the problem. */
     unsigned int num_variables;
 
     /** @brief How many worlds we use to generate the Kripke model. */
     unsigned int num_worlds;
 
-    /** @brief What are the edges from world w_i to world w_j (store as a Matrix [nbWorlds][nbWorlds]). */
-    vector<unsigned int>** edges;
+    /** @brief How many worlds there are in the solution (num_worlds may be less, after Kripke::pruneUnreachable). */
+    unsigned int declaredWorlds;
+
+    /** @brief The id in the solution of each world kept by Kripke::pruneUnreachable (empty if nothing was pruned). */
+    vector<unsigned int> originalIds;
+
+    /** @brief The edges from world w_i are edgeTargets[edgeOffsets[i]] ... edgeTargets[edgeOffsets[i+1]-1] (nbWorlds+1 offsets). */
+    vector<uint64_t> edgeOffsets;
+
+    /** @brief The arrival worlds of every edge, sorted by starting world (Compressed Sparse Row). */
+    vector<unsigned int> edgeTargets;
+
+    /** @brief The offsets of the edges in use (edgeOffsets, or the ones of the binary model). */
+    const uint64_t* offsetData;
+
+    /** @brief The targets of the edges in use (edgeTargets, or the ones of the binary model). */
+    const unsigned int* targetData;
+
+    /** @brief The predecessors of w_i are predecessorTargets[predecessorOffsets[i]] ... (empty until they are needed). */
+    vector<uint64_t> predecessorOffsets;
+
+    /** @brief The starting worlds of every edge, sorted by arrival world. */
+    vector<unsigned int> predecessorTargets;
+
+    /** @brief The edges read but not yet in the CSR arrays, as pairs (w1,w2). */
+    vector<unsigned int> pendingEdges;
+
+    /** 
+     * @brief What are the assignations of propositionals variables for each world (store as a Matrix [nbWorlds][nbVariables]).
+     *
+     * Each cell is 2 bits (01 assigned positively, 10 assigned negatively, 00 not assigned) and each row starts on a new word.
+     */
+    vector<uint64_t> valuations;
+
+    /** @brief The valuation matrix in use (valuations, or the one of the binary model). */
+    const uint64_t* valuationData;
+
+    /** @brief The binary model, if the model was loaded from one (NULL otherwise). */
+    const char* binaryData;
+
+    /** @brief The number of bytes of the binary model. */
+    size_t binarySize;
+
+    /** @brief true if the binary model is a mapped file, false if it was allocated by malloc. */
+    bool binaryMapped;
+
+    /** @brief The first bytes of a binary model. */
+    static const char BINARY_MAGIC[5];
+
+    /** @brief How many 64-bit words there is in a row of the valuation matrix. */
+    size_t rowWords;
+
+    /** @brief How many variables are in the transposed bitsets (0 while they are not built). */
+    unsigned int nbTransposedVariables;
+
+    /** @brief How many 64-bit words there is in the bitset of a variable. */
+    size_t wordsPerVariable;
+
+    /** @brief For each variable (the bitset 0 is empty), the worlds where it is assigned positively. */
+    vector<uint64_t> worldsWhereTrue;
+
+    /** @brief For each variable (the bitset 0 is empty), the worlds where it is assigned negatively. */
+    vector<uint64_t> worldsWhereFalse;
+
+    /** @brief For each world, the AND of the rows of its successors (all the bits set if there is none). */
+    vector<uint64_t> everySuccessor;
 
-    /** @brief What are the assignations of propositionals variables for each world (store as a Matrix [nbWorlds][nbVariables]). */
-    vector<vector<int> > assignations;
+    /** @brief For each world, the OR of the rows of its successors. */
+    vector<uint64_t> someSuccessor;
 
 };
 
@@ -0,0 +1,276 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+#ifndef KRIPKE_READER_H_INCLUDED
+#define KRIPKE_READER_H_INCLUDED
+
+#include "Kripke.h"
+
+#include <utility>
+
+/**
+ * \file KripkeReader.h
+ * @brief Description of the class KripkeReader.
+ *
+ * A KripkeReader parses a Kripke-CNF solution and stores it in a Kripke model.
+ *
+ * @version 1.0
+ */
+
+/**
+ * \class KripkeReader
+ *
+ * @brief A KripkeReader parses a Kripke-CNF solution, in place, and stores it in a Kripke model.
+ *
+ * A Kripke-CNF solution is made of lines:
+ *
+ * - "c ..." a comment.
+ * - "s SATISFIABLE" (or "s UNSATISFIABLE").
+ * - "v nbVariables nbWorlds nbEdges" the first 'v' line, describing the model.
+ * - "v l1 l2 ... 0" the nbWorlds following 'v' lines, the literals assigned in w0, w1, ...
+ * - "v r1 wi wj" the other 'v' lines, the edges wi --> wj.
+ *
+ * A regular file is mapped in memory and parsed without any copy.
+ * Anything else (a pipe, STDIN) is read by large blocks, and only the unfinished last line of a block is moved.
+ * There is no limit on the length of a line.
+ *
+ * The tokens of a line are found 64 bytes at a time (AVX-512, AVX2 or scalar, chosen at runtime),
+ * and the integers are decoded 8 digits at a time.
+ *
+ * A binary model (see Kripke::writeBinary) is recognized by its first bytes and used without any parsing.
+ * A compressed solution (gzip, xz, zstd) is recognized by its first bytes too, and decompressed on another thread.
+ *
+ * With several threads, a mapped file is cut in chunks (on '\n') after the header:
+ *
+ * - each thread counts the 'v' lines of its chunk, and a prefix sum gives the index of the first line of each chunk;
+ * - each thread parses its chunk, assigns the valuations in place (the rows of 2 worlds never share a word)
+ *   and keeps its edges, which are then copied in the order of the file at the place given by another prefix sum.
+ *
+ * With a pruning depth (see Kripke::pruneUnreachable), only the worlds close enough to w0 are kept.
+ * In a mapped file, the valuation lines are only located while the edges are read,
+ * and only the ones of the worlds kept are parsed, so the valuations of the other worlds are never stored.
+ * A stream (the STDIN, a pipe, a compressed solution) and a binary model are fully loaded, then pruned:
+ * the check is as fast, but the whole model is in memory while it is read.
+ */
+class KripkeReader {
+
+public:
+
+    /**
+     * @brief The scanner of a block of 64 bytes: the bit i of the result is set if the byte i is a blank or a '\n'.
+     */
+    typedef uint64_t (*scanner_t)(const char* p);
+
+    /** @brief The best scanner for the current CPU (AVX-512, AVX2 or scalar). */
+    static scanner_t scanBlock;
+
+    /**
+     * @brief To construct a reader, we need the Kripke model in which the solution will be stored.
+     *
+     * @param[in] kripke the Kripke model to fill.
+     */
+    KripkeReader(Kripke & kripke);
+
+    /**
+     * @brief This method will parse the solution in the file 'path' (mapped in memory if it is a regular file).
+     *
+     * @param[in] path the path of the Kripke-CNF solution.
+     */
+    void readFile(const char* path);
+
+    /**
+     * @brief This method will parse the solution read, by large blocks, from the file descriptor 'fd'.
+     *
+     * @param[in] fd the file descriptor of the Kripke-CNF solution (0 for STDIN).
+     */
+    void readStream(int fd);
+
+    /**
+     * @brief This method will set how many threads can parse a mapped file at the same time.
+     *
+     * @param[in] nbThreads the number of threads (1 to parse sequentially).
+     */
+    void setNbThreads(unsigned int nbThreads) { this->nbThreads = max(nbThreads, 1u); }
+
+    /**
+     * @brief This method will set the modal depth of the formula, the worlds further from w0 are not kept.
+     *
+     * @param[in] depth the modal depth (Kripke::NO_PRUNING to keep every world).
+     */
+    void setPruneDepth(unsigned int depth) { pruneDepth = depth; }
+
+    /**
+     * @brief This method will return the name of the instructions used to find the lines and the tokens.
+     *
+     * @return "avx512", "avx2" or "scalar".
+     */
+    static const char* getScannerName() { return scannerName; }
+
+private:
+
+    /**
+     * \struct Chunk
+     *
+     * @brief A part of the mapped file (whole lines) parsed by one thread.
+     */
+    struct Chunk {
+
+        /** @brief The first character of the chunk. */
+        const char* begin;
+
+        /** @brief After the last character of the chunk. */
+        const char* end;
+
+        /** @brief The index (after the header) of the first 'v' line of the chunk. */
+        unsigned int firstLine;
+
+        /** @brief The number of 'v' lines in the chunk. */
+        unsigned int nbLines;
+
+        /** @brief true if the chunk contains "s SATISFIABLE". */
+        bool satisfiable;
+
+        /** @brief true if the chunk contains "s UNSATISFIABLE". */
+        bool unsatisfiable;
+
+        /** @brief The edges of the chunk, as pairs (w1,w2), in the order of the file. */
+        vector<unsigned int> edges;
+
+        /** @brief The literals which do not fit in the rows yet, as pairs (literal,world), assigned after the threads. */
+        vector<pair<int,unsigned int> > lateLiterals;
+    };
+
+    /**
+     * @brief This method will parse a mapped file [begin,end[: the header alone, then the rest in chunks.
+     *
+     * @param[in] begin the first character of the file.
+     *
+     * @param[in] end after the last character of the file.
+     */
+    void parseMapped(const char* begin, const char* end);
+
+    /**
+     * @brief This method will count the 'v' lines of a chunk and look for its status lines (first pass).
+     *
+     * @param[in,out] chunk the chunk, its nbLines and status are filled.
+     */
+    static void countLines(Chunk & chunk);
+
+    /**
+     * @brief This method will parse the 'v' lines of a chunk (second pass).
+     *
+     * @param[in,out] chunk the chunk, its edges and late literals are filled.
+     */
+    void parseChunk(Chunk & chunk);
+
+    /**
+     * @brief This method will read the rest of a binary model from the file descriptor 'fd' and give it to the Kripke model.
+     *
+     * @param[in] fd the file descriptor of the binary model.
+     *
+     * @param[in] start the bytes already read.
+     *
+     * @param[in] size the number of bytes already read.
+     */
+    void readBinaryStream(int fd, const char* start, size_t size);
+
+    /**
+     * @brief This method will parse every complete line in [begin,end[.
+     *
+     * @param[in] begin the first character.
+     *
+     * @param[in] end after the last character.
+     *
+     * @return the beginning of the last line if it is not finished by '\n', end otherwise.
+     */
+    const char* parseLines(const char* begin, const char* end);
+
+    /**
+     * @brief This method will parse one line [begin,end[ (without the '\n').
+     *
+     * @param[in] begin the first character of the line.
+     *
+     * @param[in] end after the last character of the line.
+     *
+     * @param[in] limit after the last byte that can be read to decode a token.
+     */
+    void parseLine(const char* begin, const char* end, const char* limit);
+
+    /**
+     * @brief This method will parse the literals of a valuation line [begin,end[ and assign them in the world 'world'.
+     *
+     * @param[in] begin the first character of the line.
+     *
+     * @param[in] end after the last character of the line.
+     *
+     * @param[in] limit after the last byte that can be read to decode a token.
+     *
+     * @param[in] world the world of the line.
+     */
+    void parseValuation(const char* begin, const char* end, const char* limit, unsigned int world);
+
+    /**
+     * @brief This method will check that the solution was complete, build the edges of the Kripke model and prune it.
+     */
+    void finish();
+
+    /**
+     * @brief This method will prune the Kripke model, then parse the valuation lines which were only located.
+     */
+    void prune();
+
+    /** @brief The Kripke model in which the solution is stored. */
+    Kripke & kripke;
+
+    /** @brief true once we read the 'v' line describing the model. */
+    bool headerFound;
+
+    /** @brief true once we read "s SATISFIABLE". */
+    bool satFound;
+
+    /** @brief The number of worlds, given by the header. */
+    unsigned int nbWorlds;
+
+    /** @brief The number of 'v' lines read after the header. */
+    unsigned int nbLines;
+
+    /** @brief How many threads can parse a mapped file at the same time. */
+    unsigned int nbThreads;
+
+    /** @brief The modal depth of the formula (Kripke::NO_PRUNING to keep every world). */
+    unsigned int pruneDepth;
+
+    /** @brief true if the valuation lines are only located (a mapped file, with a pruning depth). */
+    bool deferRows;
+
+    /** @brief Where the valuation line of each world starts, while deferRows (NULL if there is none). */
+    vector<const char*> rowLines;
+
+    /** @brief After the last character of the mapped file. */
+    const char* mappedEnd;
+
+    /** @brief The name of the best scanner for the current CPU. */
+    static const char* scannerName;
+};
+
+#endif
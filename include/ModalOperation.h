@@ -27,6 +27,15 @@
 
 #include "Operation.h"
 
+/** @brief If a chain of modal operators jumps over the worlds with only one successor (see ModalOperation::followChain). */
+#define SHRINK_CHAIN_OF_WORLDS true
+
+/** @brief The number of witness worlds remembered by a diamond. */
+#define NB_WITNESS_WORLDS 2
+
+/** @brief No witness world is remembered at this place. */
+#define NO_WITNESS (~0u)
+
 /**
  * \file ModalOperation.h
  * @brief Description of the class ModalOperation.
@@ -94,6 +103,13 @@ public:
        */
       virtual void propagateInfoAboutModalChains(unsigned int & chainSize);
 
+      /**
+       * @brief This method will return the modal depth of the Term: one more than the modal depth of its child.
+       *
+       * @return the modal depth (at least 1).
+       */
+      virtual unsigned int getModalDepth() { return 1 + Term::getModalDepth(); }
+
       /**
        * @brief This method will recursively propagates the association of equivalent boolean operators.
        *
@@ -130,16 +146,139 @@ public:
 
        * @param[in] w the world in which we are checking the satisfiability of the current ModalOperation.
 
+       * @param[in,out] context the context of the check (its reason is set if the result is {KO,UNKNOWN}).
+
        * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current ModalOperation.
        * 
        */
-      virtual unsigned int checkBranch(Kripke & kripke, unsigned int w);
+      virtual unsigned int checkBranch(Kripke & kripke, unsigned int w, CheckContext & context);
+
+      /**
+       * @brief This method will check the branch in the world w, the successors of w being shared in tasks of the pool of the context.
+       * 
+       * A successor where the child is OK cancels the other tasks of a diamond.
+       * A successor where the child is not OK cancels the tasks of the next successors of a box (the first one gives the result).
+       *
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+       *
+       * @param[in] w the world in which we are checking the satisfiability of the current ModalOperation.
+       *
+       * @param[in,out] context the context of the current task (with a pool, and a group telling if the result is still needed).
+       *
+       * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current ModalOperation, NOT_YET if the check was cancelled.
+       */
+      virtual unsigned int checkBranchInParallel(Kripke & kripke, unsigned int w, CheckContext & context);
+
+      /**
+       * @brief This method will follow the worlds with only one successor, as long as the chain of modal operators goes on.
+       *
+       * () -> () -> (p1) checked by [r1][r1][r1]p1 in the first world is [r1]p1 checked in the third world.
+       *
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+       *
+       * @param[in,out] w the world where the chain starts, then the world where it stops.
+       *
+       * @return the ModalOperation of the chain to check in the new w.
+       */
+      Term* followChain(Kripke & kripke, unsigned int & w);
+
+      /**
+       * @brief This method will return the sub-formula to check in the successors of w, once the chain of worlds is shrunk (if it is).
+       *
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+       *
+       * @param[in,out] w the world in which the ModalOperation is checked, then the world whose successors have to be checked.
+       *
+       * @return the child of the ModalOperation of the chain which is checked in w.
+       */
+      Term* getCheckedChild(Kripke & kripke, unsigned int & w) { return (SHRINK_CHAIN_OF_WORLDS ? followChain(kripke,w) : this)->getChild(0); }
+
+      /**
+       * @brief This method will compute, for every world of the solution kripke, if the ModalOperation is {OK,KO,UNKNOWN} in it.
+       * 
+       * The child is labeled once, then every edge of the Kripke model is read once.
+       *
+       * If the child is OK (for a diamond) or not OK (for a box) in only a few worlds, 
+       * we go instead from these worlds to their predecessors (see ModalOperation::labelBackward).
+       *
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+       *
+       * @param[out] labels labels[w] is {OK,KO,UNKNOWN} according to the labels of the child in the worlds connected to w.
+       *
+       * @param[in,out] context the context of the check (its cache gets the labels of the Operations, see Term::storeLabels).
+       */
+      virtual void labelWorlds(Kripke & kripke, WorldSet & labels, CheckContext & context);
+
+      /**
+       * @brief This method will compute the labels from the worlds where the child decides (OK for a diamond, not OK for a box) to their predecessors.
+       *
+       * The work is proportional to the number of predecessors of these worlds, instead of the number of edges of the model.
+       *
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+       *
+       * @param[in] childLabels the labels of the child in every world.
+       *
+       * @param[out] labels labels[w] is {OK,KO,UNKNOWN} according to the labels of the child in the worlds connected to w.
+       *
+       * @return true if the labels were computed, false if there are too many predecessors (the edges have to be read forward).
+       */
+      bool labelBackward(Kripke & kripke, const WorldSet & childLabels, WorldSet & labels);
 
 private:
 
+      /**
+       * @brief This method will check the ModalOperation in w from the aggregates of the successors of w, if the child to check is a literal.
+       *
+       * A diamond is OK if the literal is OK in one successor, UNKNOWN otherwise. A box is OK if the literal is OK in every successor,
+       * otherwise the first successor where it is not OK has to be found (its result and its reason are the ones of the box).
+       *
+       * @param[in] kripke the Kripke model, with its aggregates (see Kripke::aggregateSuccessors).
+       *
+       * @param[in] w the world whose successors are read (once the chain of worlds is shrunk).
+       *
+       * @param[in] child the child to check in the successors of w.
+       *
+       * @return {OK,UNKNOWN} if the aggregates give the result, NOT_YET if the successors have to be checked.
+       */
+      unsigned int checkFromAggregates(Kripke & kripke, unsigned int w, Term* child);
+
+      /**
+       * @brief This method will check the child of the diamond in the successors of w, the last witnesses first.
+       *
+       * The successor at the place of the last witness is checked first, then the last witness worlds which are successors of w,
+       * then the other successors in their order. Same result as the scan of the successors in their order.
+       *
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+       *
+       * @param[in] w the world whose successors are checked (once the chain of worlds is shrunk).
+       *
+       * @param[in,out] context the context of the check.
+       *
+       * @return OK if the child is OK in a successor of w, UNKNOWN otherwise (the reason is not set).
+       */
+      unsigned int checkDiamond(Kripke & kripke, unsigned int w, CheckContext & context);
+
+      /**
+       * @brief This method will remember the successor where the child of the diamond was OK.
+       *
+       * @param[in] position the index of the witness in the successors of the checked world.
+       *
+       * @param[in] world the witness.
+       */
+      void rememberWitness(unsigned int position, unsigned int world);
+
       /** @brief This checker will become a Multi-Agent checker, so we need to already think about storing the ID of the agent. */
 	unsigned int agent;
 
+      /** @brief The index of the last witness of the diamond, in the successors of the world where it was found. */
+      unsigned int witnessPosition;
+
+      /** @brief The last worlds where the child of the diamond was OK (NO_WITNESS if none yet). */
+      unsigned int witnessWorlds[NB_WITNESS_WORLDS];
+
+      /** @brief The place in witnessWorlds of the next witness to remember. */
+      unsigned int nextWitness;
+
 };
 
 #endif
\ No newline at end of file
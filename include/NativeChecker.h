@@ -0,0 +1,149 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+#ifndef NATIVE_CHECKER_H_INCLUDED
+#define NATIVE_CHECKER_H_INCLUDED
+
+#include "Bytecode.h"
+
+#include <string>
+
+/**
+ * \file NativeChecker.h
+ * @brief Description of the class NativeChecker.
+ *
+ * A NativeChecker translates the Bytecode of a formula into C++, builds it into a shared object with the compiler
+ * of the machine, and loads it: the formula is then checked by machine code written for it alone.
+ *
+ * @version 1.0
+ */
+
+/**
+ * \class NativeChecker
+ *
+ * @brief The checker of one formula, generated in C++ and loaded from a shared object.
+ *
+ * Each Operation becomes a function:
+ *
+ * - the literals are tested inline, with their variable and their polarity as constants;
+ * - the children of an AND (OR) are unrolled, one test after the other;
+ * - a box (diamond) has one loop over the successors per length of its chain of modal operators.
+ *
+ * The results, the short-circuits, the use of the cache and the reasons are exactly the ones of Term::check.
+ *
+ * The shared object is named after a hash of its source, in the directory $XDG_CACHE_HOME/mdk-verifier (~/.cache/mdk-verifier by default):
+ * a formula checked against many models is only compiled the first time. This directory, and every object loaded from it,
+ * has to belong to the current user and be writable by nobody else. Without it, the object is built in a new directory of $TMPDIR.
+ * The compiler is $CXX (the one which built the verifier by default), run without any shell.
+ *
+ * The verifier has to be built with WITH_NATIVE=1 (it then exports its symbols to the checkers), otherwise NativeChecker::load fails.
+ */
+class NativeChecker {
+
+public:
+
+    /**
+     * @brief The function generated for the formula: it checks the formula in the world w.
+     */
+    typedef unsigned int (*native_t)(Kripke & kripke, unsigned int w, CheckContext & context, Term* const* terms);
+
+    /**
+     * @brief To construct a NativeChecker, we need the root of the simplified formula (with its chains and its ids).
+     *
+     * @param[in] root the root of the formula.
+     */
+    NativeChecker(Term* root);
+
+    /**
+     * @brief This method is the destructor, it will unload the shared object.
+     */
+    ~NativeChecker();
+
+    /**
+     * @brief This method will build the shared object (if it is not already built) and load it.
+     *
+     * @return true if the generated checker can be used, false if it can not be built or loaded.
+     */
+    bool load();
+
+    /**
+     * @brief This method will check if the formula is {OK,KO,UNKNOWN} in the world w (NativeChecker::load has to be successful).
+     *
+     * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+     *
+     * @param[in] w the world in which we are checking the satisfiability of the formula.
+     *
+     * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+     *
+     * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the formula.
+     */
+    unsigned int check(Kripke & kripke, unsigned int w, CheckContext & context) const { return function(kripke,w,context,program.getTerms()); }
+
+    /**
+     * @brief This method will return the generated source.
+     *
+     * @return the C++ source of the checker.
+     */
+    const string & getSource() const { return source; }
+
+private:
+
+    /**
+     * @brief This method will append the functions of the instruction pc and of its descendants (the descendants first).
+     *
+     * @param[in] pc the index of the instruction.
+     */
+    void generate(uint32_t pc);
+
+    /**
+     * @brief This method will return the C++ expression checking the instruction pc in the world 'world'.
+     *
+     * @param[in] pc the index of the instruction.
+     *
+     * @param[in] world the name of the variable holding the world.
+     *
+     * @return a literal test, a constant or the call of the function of an Operation.
+     */
+    string expression(uint32_t pc, const char* world) const;
+
+    /**
+     * @brief This method will append printf-like formatted text to the source.
+     *
+     * @param[in] format the format, followed by its arguments.
+     */
+    void emit(const char* format, ...);
+
+    /** @brief The instructions of the formula. */
+    Bytecode program;
+
+    /** @brief The C++ source of the checker. */
+    string source;
+
+    /** @brief The handle of the shared object (NULL if it is not loaded). */
+    void* handle;
+
+    /** @brief The generated function (NULL if it is not loaded). */
+    native_t function;
+};
+
+#endif
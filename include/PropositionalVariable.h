@@ -69,7 +69,7 @@ public:
       * @param[in] value the ID of the Variable.
       *
       */ 
-      PropositionalVariable(unsigned int value) : Variable(value) { setId(value); }
+      PropositionalVariable(unsigned int value) : Variable(value) { setId(value); kind = K_VARIABLE; }
 
       /**
        * @brief To destroy a PropositionalVariable, we basically have nothing to do.
@@ -113,9 +113,22 @@ public:
        *
        * @param[in] world the world in which we are checking the satisfiability of the current PropositionalVariable.
        *
+       * @param[in,out] context the context of the check (its reason is set if the result is {KO,UNKNOWN}).
+       *
        * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current PropositionalVariable.
        */
-      virtual unsigned int checkBranch(Kripke & kripke, unsigned int world);
+      virtual unsigned int checkBranch(Kripke & kripke, unsigned int world, CheckContext & context);
+
+      /**
+       * @brief This method will compute, for every world of the solution kripke, if the PropositionalVariable is {OK,KO,UNKNOWN} in it.
+       * 
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+       *
+       * @param[out] labels labels[w] is {OK,KO,UNKNOWN} according to the assignation of the PropositionalVariable in w.
+       *
+       * @param[in,out] context the context of the check (its cache gets the labels of the Operations, see Term::storeLabels).
+       */
+      virtual void labelWorlds(Kripke & kripke, WorldSet & labels, CheckContext & context);
 
 private:
     
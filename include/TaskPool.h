@@ -0,0 +1,242 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+#ifndef TASK_POOL_H_INCLUDED
+#define TASK_POOL_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <stddef.h>
+
+/**
+ * \file TaskPool.h
+ * @brief Description of the classes TaskGroup, Task and TaskPool.
+ *
+ * A TaskPool runs small tasks on a fixed number of threads, each thread stealing the tasks of the others when it has nothing to do.
+ *
+ * @version 1.0
+ */
+
+/**
+ * \class TaskGroup
+ *
+ * @brief The tasks spawned together, which can be waited for and cancelled together.
+ *
+ * A group is cancelled if it was cancelled itself, or if one of its parents was.
+ */
+class TaskGroup {
+
+public:
+
+    /**
+     * @brief To construct a group, we need the group of the task which creates it.
+     *
+     * @param[in] parent the enclosing group (NULL for the first one).
+     */
+    TaskGroup(TaskGroup* parent = NULL) : parent(parent), pending(0), cancelled(false) { }
+
+    /**
+     * @brief This method will cancel the group: its tasks, and the groups created by its tasks, should stop as soon as possible.
+     */
+    void cancel() { cancelled.store(true, std::memory_order_relaxed); }
+
+    /**
+     * @brief This method will tell if the group, or one of its parents, was cancelled.
+     *
+     * @return true if the work of the group is not needed anymore.
+     */
+    bool isCancelled() const {
+      for(const TaskGroup* g = this; g != NULL; g = g->parent) if(g->cancelled.load(std::memory_order_relaxed)) return true;
+      return false;
+    }
+
+private:
+
+    friend class TaskPool;
+
+    /** @brief The enclosing group. */
+    TaskGroup* parent;
+
+    /** @brief The number of tasks of the group which are not finished. */
+    std::atomic<unsigned int> pending;
+
+    /** @brief true once the group is cancelled. */
+    std::atomic<bool> cancelled;
+};
+
+/**
+ * \class Task
+ *
+ * @brief A piece of work which can be run by any thread of a TaskPool.
+ *
+ * The task belongs to the one who spawns it, and it has to live until TaskPool::wait returns.
+ */
+class Task {
+
+public:
+
+    /** @brief The default constructor, the task is not in a group yet. */
+    Task() : group(NULL) { }
+
+    /** @brief The destructor. */
+    virtual ~Task() { }
+
+    /** @brief This method is the work of the task. */
+    virtual void run() = 0;
+
+private:
+
+    friend class TaskPool;
+
+    /** @brief The group of the task (given by TaskPool::spawn). */
+    TaskGroup* group;
+};
+
+/**
+ * \class TaskPool
+ *
+ * @brief A work-stealing pool: each thread has its own deque of tasks.
+ *
+ * - a thread pushes and pops its tasks at the back of its deque (the last spawned is the first run, like a recursive call);
+ * - a thread without task steals at the front of the deque of another thread (the oldest, so the largest piece of work);
+ * - a thread which waits for a group runs tasks meanwhile, so nobody sleeps while there is work.
+ *
+ * The thread which creates the pool is the first thread of the pool.
+ */
+class TaskPool {
+
+public:
+
+    /**
+     * @brief To construct a pool, we need how many threads (the calling one included) run the tasks.
+     *
+     * @param[in] nbThreads the number of threads (at least 1).
+     */
+    TaskPool(unsigned int nbThreads);
+
+    /**
+     * @brief This method is the destructor, it will stop and join the threads of the pool.
+     */
+    ~TaskPool();
+
+    /**
+     * @brief This method will give a task to the pool.
+     *
+     * @param[in] task the task (it has to live until TaskPool::wait returns for its group).
+     *
+     * @param[in] group the group of the task.
+     */
+    void spawn(Task* task, TaskGroup & group);
+
+    /**
+     * @brief This method will run tasks until every task of the group is finished.
+     *
+     * @param[in] group the group that we wait for.
+     */
+    void wait(TaskGroup & group);
+
+    /**
+     * @brief This method will tell if there are enough tasks waiting to keep every thread busy.
+     *
+     * @return true if spawning more tasks would only cost time.
+     */
+    bool isBusy() const { return queued.load(std::memory_order_relaxed) >= nbThreads; }
+
+    /**
+     * @brief This method will return how many threads run the tasks.
+     *
+     * @return the number of threads of the pool.
+     */
+    unsigned int getNbThreads() const { return nbThreads; }
+
+private:
+
+    /**
+     * \struct Worker
+     *
+     * @brief The deque of tasks of one thread.
+     */
+    struct Worker {
+
+        /** @brief Protects the deque (the owner and the thieves). */
+        std::mutex lock;
+
+        /** @brief The tasks spawned by the thread, the last one at the back. */
+        std::deque<Task*> tasks;
+    };
+
+    /**
+     * @brief This method is the loop of the threads of the pool, until the pool is destroyed.
+     *
+     * @param[in] index the index of the thread in the pool.
+     */
+    void workerLoop(unsigned int index);
+
+    /**
+     * @brief This method will return a task to run: the last one of the thread, or one stolen to another thread.
+     *
+     * @return a task, or NULL if there is none.
+     */
+    Task* take();
+
+    /**
+     * @brief This method will run a task, and tell its group that it is finished.
+     *
+     * @param[in] task the task to run.
+     */
+    void execute(Task* task);
+
+    /** @brief The number of threads running the tasks. */
+    unsigned int nbThreads;
+
+    /** @brief One deque per thread. */
+    std::vector<Worker*> workers;
+
+    /** @brief The threads of the pool (the first thread of the pool is the one which created it). */
+    std::vector<std::thread> threads;
+
+    /** @brief The number of tasks in the deques. */
+    std::atomic<size_t> queued;
+
+    /** @brief The number of threads sleeping until a task is spawned. */
+    std::atomic<unsigned int> nbSleeping;
+
+    /** @brief true once the pool is destroyed. */
+    std::atomic<bool> stopping;
+
+    /** @brief To sleep while there is no task. */
+    std::mutex sleepLock;
+
+    /** @brief To wake up the threads when a task is spawned. */
+    std::condition_variable wakeUp;
+
+    /** @brief The index of the current thread in the pool. */
+    static thread_local unsigned int workerIndex;
+};
+
+#endif
@@ -25,6 +25,8 @@
 #define TERM_H_INCLUDED
 
 #include "Def.h"
+#include "CheckContext.h"
+#include "WorldSet.h"
 
 /**
  * \file Term.h
@@ -49,19 +51,22 @@ class Term {
 
 	public:  
 
+      /** @brief The id of a Term which did not get one yet (see Term::setTermIds). */
+      static const unsigned int NO_ID = ~0u;
+
 		  /**
        * @brief This method represents the default constructor.
        * 
        * It will just initialize the list of children empty and say that the element is positive.
        */
-  		Term () { negated = false; modalTermChainSize = 0; }
+  		Term () { negated = false; modalTermChainSize = 0; termId = NO_ID; kind = K_CONSTANT; cached = true; creation = nbCreated++; }
 
   		/**
        * @brief This method represents the recopy constructor.
        * 
        * If the Term that we are copying is negated, we will be also. And they will have the same list of children.
        */
-  		Term (Term& term) { negated = term.negated; modalTermChainSize = term.negated; }
+  		Term (Term& term) { negated = term.negated; modalTermChainSize = term.negated; termId = NO_ID; kind = term.kind; cached = true; creation = nbCreated++; }
 
   		/**
        * @brief This method represents the destructor of the class. It will just clear the list of children.
@@ -93,6 +98,20 @@ class Term {
        */
   		inline bool isNegated() { return negated; }
 
+      /**
+       * @brief This method will return what the Term is (given by the constructor of each class).
+       * 
+       * @return K_CONSTANT, K_VARIABLE, K_BOOLEAN or K_MODAL.
+       */
+      inline kind_t getKind() const { return kind; }
+
+      /**
+       * @brief This method will tell if the Term is an Operation.
+       * 
+       * @return true for a BooleanOperation or a ModalOperation.
+       */
+      inline bool isOperation() const { return kind >= K_BOOLEAN; }
+
       /**
        * @brief This method will add the parameter as a new child of the Term.
        * 
@@ -125,6 +144,19 @@ class Term {
        */
       virtual void propagateInfoAboutModalChains(unsigned int & chainSize) { }
 
+      /**
+       * @brief This method will return the modal depth of the Term: the largest number of nested modal operators.
+       *
+       * @return the modal depth (0 for a propositional Term).
+       *
+       * @note checked in w, the Term only depends on the worlds at distance at most getModalDepth() from w.
+       */
+      virtual unsigned int getModalDepth() {
+        unsigned int depth = 0;
+        for(unsigned int i = 0; i < children.size(); i++) depth = max(depth, children[i]->getModalDepth());
+        return depth;
+      }
+
       /**
        * @brief This method will set the Father of the current Term.
        * 
@@ -155,6 +187,15 @@ class Term {
        */
       void deleteChild(unsigned int i);
 
+      /**
+       * @brief This method will replace the i-th child of the current Term (the old one is not deleted).
+       * 
+       * @param[in] i the index of the child that we want to replace.
+       *
+       * @param[in] child the new i-th child.
+       */
+      void setChild(unsigned int i, Term* child) { children[i] = child; }
+
       /**
        * @brief This method will display the current Term and also its children
        * 
@@ -173,11 +214,126 @@ class Term {
 
        * @param[in] w the world in which we are checking the satisfiability of the current Term.
 
+       * @param[in,out] context the context of the check (its reason is set if the result is {KO,UNKNOWN}).
+
        * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current Term.
        * 
        * @note Term is abstract, so by default it is returning UNKNOWN, but it should normally never be call.
        */
-      virtual unsigned int checkBranch(Kripke & kripke, unsigned int w) { return UNKNOWN; }
+      virtual unsigned int checkBranch(Kripke & kripke, unsigned int w, CheckContext & context) { return UNKNOWN; }
+
+      /**
+       * @brief This method will compute, for every world of the solution kripke, if the Term is {OK,KO,UNKNOWN} in it.
+       * 
+       * This is the bottom-up labeling: the children are labeled first, then the Term is labeled from its children.
+       *
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+
+       * @param[out] labels labels[w] is {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current Term in w.
+
+       * @param[in,out] context the context of the check (its cache gets the labels of the Operations, see Term::storeLabels).
+       * 
+       * @note Term is abstract, so by default every world is UNKNOWN, but it should normally never be call.
+       */
+      virtual void labelWorlds(Kripke & kripke, WorldSet & labels, CheckContext & context) { labels.assign(kripke.getNbWorlds(),UNKNOWN); }
+
+      /**
+       * @brief This method will store the labels of the Term in the cache of the context, if its results are stored there.
+       *
+       * The reason of a {KO,UNKNOWN} label in w0 is then found by checkBranch in w0 (see Formula::checkFormulaByLabeling):
+       * the children give their labels, so only the path which decides the label of the root is followed.
+       *
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+       *
+       * @param[in] labels labels[w] is {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current Term in w.
+       *
+       * @param[in,out] context the context of the check (its cache gets the labels).
+       */
+      void storeLabels(Kripke & kripke, const WorldSet & labels, CheckContext & context);
+
+      /**
+       * @brief This method will check the Term in the world w, looking first in the cache if there is one.
+       * 
+       * A Term without children is cheaper to check than to look for, so only Operation results are stored
+       * (but the ones of a clause or a cube of literals, see BooleanOperation::compileLiteralMasks).
+       *
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+
+       * @param[in] w the world in which we are checking the satisfiability of the current Term.
+
+       * @param[in,out] context the context of the check (its cache, its reason and its statistics).
+
+       * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current Term.
+       */
+      inline unsigned int check(Kripke & kripke, unsigned int w, CheckContext & context) {
+
+        context.countCheck();
+
+        if(context.getCache() == NULL || children.empty() || !cached) return checkBranch(kripke,w,context);
+
+        unsigned int res = context.lookup(termId,w,this);
+
+        if(res == NOT_YET) {
+          res = checkBranch(kripke,w,context);
+          context.getCache()->store(termId,w,res);
+        }
+
+        return res;
+      }
+
+      /**
+       * @brief This method will check the Term in the world w, giving parts of the work to the other threads of the pool of the context.
+       * 
+       * Like Term::check, the result is looked for (and stored) in the cache.
+       * If the pool is busy enough, or if the Term has no children, it is just Term::check.
+       *
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+       *
+       * @param[in] w the world in which we are checking the satisfiability of the current Term.
+       *
+       * @param[in,out] context the context of the current task (with a pool, and a group telling if the result is still needed).
+       *
+       * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current Term, NOT_YET if the check was cancelled.
+       */
+      unsigned int checkInParallel(Kripke & kripke, unsigned int w, CheckContext & context);
+
+      /**
+       * @brief This method will check if the branch is {OK,KO,UNKNOWN} in the world w, giving parts of the work to the other threads of the pool of the context.
+       * 
+       * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+       *
+       * @param[in] w the world in which we are checking the satisfiability of the current Term.
+       *
+       * @param[in,out] context the context of the current task (with a pool, and a group telling if the result is still needed).
+       *
+       * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current Term, NOT_YET if the check was cancelled.
+       *
+       * @note by default, the branch is checked by the current thread (see BooleanOperation and ModalOperation).
+       */
+      virtual unsigned int checkBranchInParallel(Kripke & kripke, unsigned int w, CheckContext & context) { return checkBranch(kripke,w,context); }
+
+      /**
+       * @brief This method will recursively give an id to the Term and all its sub-formulae.
+       * 
+       * A sub-formula shared by several Terms (see Formula::shareSubformulas) gets only one id.
+       *
+       * @param[in] nextId the next id available, it will be increased for each Term.
+       *
+       * @note the ids have to be cleared before (see Term::clearTermIds).
+       */
+      void setTermIds(unsigned int & nextId);
+
+      /**
+       * @brief This method will recursively give the id NO_ID to the Term and all its sub-formulae.
+       */
+      void clearTermIds();
+
+      /**
+       * @brief This method will return the id of the Term in the formula.
+       * 
+       * @return the id of the Term (given by Term::setTermIds).
+       */
+      unsigned int getTermId() const { return termId; }
 
       /**
        * @brief This method will recursively propagates the association of equivalent boolean operators.
@@ -223,33 +379,13 @@ class Term {
       unsigned int getModalTermChainSize() { return modalTermChainSize; }
 
       /**
-       * @brief This function will recursively sort all the children of every Term by the order as follow.
+       * @brief This function will recursively sort all the children of every Term in the order in which they were created.
        *
-       * - First PropositionalVariable and BooleanConstant
-       * - Second BooleanOperation with a lot of children.
-       * - Third  BooleanOperation with few children.
-       * - Last   ModalOperator.
+       * The children are checked in this order, which gives the reason of a {KO,UNKNOWN} result.
+       * The order of operator< is only used with the order by cost (see Formula::orderChildrenByCost).
        */
       virtual void orderChildren();
 
-      /**
-       * @brief according to the code stored and the pointer of the Term*, this method will return an adapted message.
-       * 
-       * @return an adapted message according to the code and the Term* stored statically.
-       */
-      static string getReasonUnchecked();
-
-      /**
-       * @brief This method will set the Checking Code, a pointer to the Term causing this reason and the world in which it happened.
-       * 
-       * @param[in] t a pointer to the Term that cause the call of Term::setReason
-       * 
-       * @param[in] c the Checking code set as the reason @see Def.h
-       * 
-       * @param[in] w the world in which the call of Term::setReason happened.
-       */
-      static void setReason(Term* t, unsigned int c,unsigned int w) { nodeReason = t; code = c; worldReason = w; }
-
 	protected: 
 
     /**
@@ -278,22 +414,30 @@ class Term {
      */
     unsigned int modalTermChainSize;
 
-  private:
+    /**
+     * @brief The id of the Term in the formula, used to store its results in the cache.
+     */
+    unsigned int termId;
+
+    /**
+     * @brief What the Term is, so the passes and the checkers can switch on it.
+     */
+    kind_t kind;
 
     /**
-     * @brief To return a reason if the checking part returns {KO,UNKNOWN} we need to have a pointer to the Term causing the {KO,UNKNOWN} 
+     * @brief false if the Term is cheaper to check than to look for in the cache (see Term::check).
      */
-    static Term* nodeReason;
+    bool cached;
 
     /**
-     * @brief the Checking code @see Def.h to understand the reason and return in 'getReasonUnchecked()' an adapted message.
+     * @brief The number of Terms created before this one (see Term::orderChildren).
      */
-    static unsigned int code;
+    unsigned long long creation;
 
-    /** 
-     * @brief The world in which the reason of {KO,UNKNOWN} appeared.
+    /**
+     * @brief The number of Terms created so far.
      */
-    static unsigned int worldReason;
+    static unsigned long long nbCreated;
 	};
 
 
@@ -0,0 +1,222 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+#ifndef WORLD_SET_H_INCLUDED
+#define WORLD_SET_H_INCLUDED
+
+#include <stdint.h>
+#include <vector>
+
+#include "Def.h"
+
+using namespace std;
+
+/**
+ * \file WorldSet.h
+ * @brief Description of the class WorldSet.
+ *
+ * A WorldSet is the label {OK,KO,UNKNOWN} of a sub-formula in every world of a Kripke model.
+ *
+ * @version 1.0
+ */
+
+/**
+ * \class WorldSet
+ *
+ * @brief The label {OK,KO,UNKNOWN} of a sub-formula in every world, stored as 2 bitsets of 64-bit words.
+ *
+ * - The bit w of 'ok' is set if the sub-formula is OK in w.
+ * - The bit w of 'ko' is set if the sub-formula is KO in w.
+ * - If none of them is set, the sub-formula is UNKNOWN in w.
+ *
+ * AND and OR are computed word by word with AVX-512, AVX2 or scalar instructions (chosen at runtime).
+ */
+class WorldSet {
+
+public:
+
+    /**
+     * @brief The kernel of AND (and of OR, by swapping ok and ko): ok &= ok2 and ko |= ko2, on n words.
+     */
+    typedef void (*kernel_t)(uint64_t* ok, uint64_t* ko, const uint64_t* ok2, const uint64_t* ko2, size_t n);
+
+    /**
+     * @brief The default constructor will just create an empty set.
+     */
+    WorldSet() { }
+
+    /**
+     * @brief This method will resize the set for nbWorlds worlds and give them all the same label.
+     *
+     * @param[in] nbWorlds the number of worlds in the Kripke model.
+     *
+     * @param[in] value the label {OK,KO,UNKNOWN} of every world.
+     */
+    void assign(unsigned int nbWorlds, unsigned int value);
+
+    /**
+     * @brief This method will copy the bitsets given as the 'ok' and 'ko' parts of the set.
+     *
+     * @param[in] nbWorlds the number of worlds in the Kripke model.
+     *
+     * @param[in] okWords the worlds which are OK (nbWords(nbWorlds) words).
+     *
+     * @param[in] koWords the worlds which are KO (nbWords(nbWorlds) words).
+     */
+    void assign(unsigned int nbWorlds, const uint64_t* okWords, const uint64_t* koWords);
+
+    /**
+     * @brief This method will return the label of the world w.
+     *
+     * @param[in] w the world.
+     *
+     * @return {OK,KO,UNKNOWN} the label of w.
+     */
+    inline unsigned int get(unsigned int w) const {
+
+      if((ok[w >> 6] >> (w & 63)) & 1) return OK;
+      if((ko[w >> 6] >> (w & 63)) & 1) return KO;
+
+      return UNKNOWN;
+    }
+
+    /**
+     * @brief This method will set the label of the world w (which has to be UNKNOWN before).
+     *
+     * @param[in] w the world.
+     *
+     * @param[in] value {OK,KO,UNKNOWN} the new label of w.
+     */
+    inline void set(unsigned int w, unsigned int value) {
+
+      if(value == OK) ok[w >> 6] |= (uint64_t) 1 << (w & 63);
+      if(value == KO) ko[w >> 6] |= (uint64_t) 1 << (w & 63);
+    }
+
+    /**
+     * @brief This method will change the label of the world w (whatever it was before).
+     *
+     * @param[in] w the world.
+     *
+     * @param[in] value {OK,KO,UNKNOWN} the new label of w.
+     */
+    inline void reset(unsigned int w, unsigned int value) {
+
+      ok[w >> 6] &= ~((uint64_t) 1 << (w & 63));
+      ko[w >> 6] &= ~((uint64_t) 1 << (w & 63));
+
+      set(w,value);
+    }
+
+    /**
+     * @brief This method will call f(w) for every world w which is OK, in increasing order.
+     *
+     * @param[in] f the function called.
+     */
+    template<typename F> void forEachOK(F f) const {
+
+      for(size_t i = 0; i < ok.size(); i++) {
+        for(uint64_t bits = ok[i]; bits != 0; bits &= bits - 1) f((unsigned int) (i * 64 + __builtin_ctzll(bits)));
+      }
+    }
+
+    /**
+     * @brief This method will call f(w) for every world w which is not OK (KO or UNKNOWN), in increasing order.
+     *
+     * @param[in] nbWorlds the number of worlds in the Kripke model.
+     *
+     * @param[in] f the function called.
+     */
+    template<typename F> void forEachNotOK(unsigned int nbWorlds, F f) const {
+
+      for(size_t i = 0; i < ok.size(); i++) {
+
+        uint64_t bits = ~ok[i];
+
+        /* The bits after the last world are not worlds. */
+        if(i + 1 == ok.size() && (nbWorlds & 63)) bits &= ((uint64_t) 1 << (nbWorlds & 63)) - 1;
+
+        for(; bits != 0; bits &= bits - 1) f((unsigned int) (i * 64 + __builtin_ctzll(bits)));
+      }
+    }
+
+    /**
+     * @brief This method will tell if w is OK.
+     *
+     * @param[in] w the world.
+     *
+     * @return true if the label of w is OK.
+     */
+    inline bool isOK(unsigned int w) const { return (ok[w >> 6] >> (w & 63)) & 1; }
+
+    /**
+     * @brief (this ^ other) in every world: KO ^ whatever is KO, OK ^ OK is OK, and the rest is UNKNOWN.
+     *
+     * @param[in] other the label of the other sub-formula.
+     */
+    void andWith(const WorldSet & other) { andKernel(ok.data(),ko.data(),other.ok.data(),other.ko.data(),ok.size()); }
+
+    /**
+     * @brief (this v other) in every world: OK v whatever is OK, KO v KO is KO, and the rest is UNKNOWN.
+     *
+     * @param[in] other the label of the other sub-formula.
+     */
+    void orWith(const WorldSet & other) { andKernel(ko.data(),ok.data(),other.ko.data(),other.ok.data(),ok.size()); }
+
+    /**
+     * @brief ~this in every world: OK becomes KO and KO becomes OK.
+     */
+    void negate() { ok.swap(ko); }
+
+    /**
+     * @brief This method will return the number of 64-bit words needed for nbWorlds worlds.
+     *
+     * @param[in] nbWorlds the number of worlds.
+     *
+     * @return the number of 64-bit words in a bitset.
+     */
+    static size_t nbWords(unsigned int nbWorlds) { return (nbWorlds + 63) / 64; }
+
+    /**
+     * @brief This method will return the name of the instructions used by AND and OR.
+     *
+     * @return "avx512", "avx2" or "scalar".
+     */
+    static const char* getKernelName() { return kernelName; }
+
+private:
+
+    /** @brief The worlds in which the sub-formula is OK. */
+    vector<uint64_t> ok;
+
+    /** @brief The worlds in which the sub-formula is KO. */
+    vector<uint64_t> ko;
+
+    /** @brief The best kernel for the current CPU. */
+    static kernel_t andKernel;
+
+    /** @brief The name of the best kernel for the current CPU. */
+    static const char* kernelName;
+};
+
+#endif
@@ -43,8 +43,10 @@
  * @param[in] kripke the Kripke model which is maybe a solution for the Formula.
  * 
  * @param[in] world the world in which we perform the check. Irrelevant here;
+ *
+ * @param[in,out] context the context of the check. Irrelevant here;
  */
-unsigned int BooleanConstant::checkBranch(Kripke & kripke, unsigned int world) {
+unsigned int BooleanConstant::checkBranch(Kripke & kripke, unsigned int world, CheckContext & context) {
 
 	if(value) return OK;
 
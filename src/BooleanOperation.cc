@@ -22,6 +22,13 @@
 ***************************************************************************************************/
 
 #include "../include/BooleanOperation.h"
+#include "../include/TaskPool.h"
+
+/** @brief In the adaptive mode, the children are sorted again after this number of checks of the BooleanOperation. */
+#define ADAPTIVE_PERIOD 512
+
+/** @brief In the adaptive mode, one check out of ADAPTIVE_SAMPLING is observed (the other ones only follow the order). */
+#define ADAPTIVE_SAMPLING 8
 
 /**
  * \file BooleanOperation.cc
@@ -50,10 +57,14 @@ BooleanOperation::BooleanOperation(Term* left, Term* right, operator_t op) {
 	assert(op == O_AND || op == O_OR); 
 	setOperator(op);
 
+  kind = K_BOOLEAN;
+
 	addChild(left);
 	addChild(right);
 
   negate(false);
+
+  checksBeforeAdapting = 0;
 }
 
 /**
@@ -68,6 +79,8 @@ BooleanOperation::BooleanOperation(BooleanOperation& boolOp) : Operation(boolOp)
   assert(boolOp.getOperator() == O_AND || boolOp.getOperator() == O_OR);
   setOperator(boolOp.getOperator());
 
+  checksBeforeAdapting = 0;
+
   size_t size = boolOp.getChildren().size();
 
   for(unsigned int i = 0; i < size; i++) {
@@ -159,7 +172,9 @@ void BooleanOperation::boolAssociation() {
 
     children[i]->boolAssociation();
 
-    if(Operation* op = dynamic_cast<Operation*>(children[i])) {
+    if(children[i]->isOperation()) {
+
+      Operation* op = static_cast<Operation*>(children[i]);
 
       if(getOperator() == op->getOperator()) {
           
@@ -192,7 +207,9 @@ void BooleanOperation::boxLifting() {
 
     children[i]->boxLifting();
 
-    if(modOp = dynamic_cast<Operation*>(children[i])) {
+    if(children[i]->isOperation()) {
+
+      modOp = static_cast<Operation*>(children[i]);
 
       if(getOperator() == O_AND && modOp->getOperator() == O_BOX) {
 
@@ -201,7 +218,9 @@ void BooleanOperation::boxLifting() {
 
           if(j == i) continue;
 
-          if(modOp2 = dynamic_cast<Operation*>(children[j])) {
+          if(children[j]->isOperation()) {
+
+            modOp2 = static_cast<Operation*>(children[j]);
 
             if(modOp2->getOperator() != O_BOX) continue;
 
@@ -225,7 +244,9 @@ void BooleanOperation::boxLifting() {
           
           if(j == i) continue;
 
-          if(modOp2 = dynamic_cast<Operation*>(children[j])) {
+          if(children[j]->isOperation()) {
+
+            modOp2 = static_cast<Operation*>(children[j]);
 
             if(modOp2->getOperator() != O_DIAMOND) continue;
 
@@ -277,10 +298,12 @@ void BooleanOperation::propagateInfoAboutModalChains(unsigned int & chainSize) {
  * 
  * @param[in] world the world in which we are checking the satisfiability of the current BooleanOperation.
  *
+ * @param[in,out] context the context of the check (its reason is set if the result is {KO,UNKNOWN}).
+ *
  * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current ModalOperation.
  * 
  */
-unsigned int BooleanOperation::checkBranch(Kripke & kripke, unsigned int world) {
+unsigned int BooleanOperation::checkBranch(Kripke & kripke, unsigned int world, CheckContext & context) {
 
   unsigned int left = UNKNOWN;
   size_t nbChildren = children.size();
@@ -290,6 +313,10 @@ unsigned int BooleanOperation::checkBranch(Kripke & kripke, unsigned int world)
   bool andOK = true;
   bool fullUnknown = true;
 
+  if(!masks.empty()) return checkLiteralMasks(kripke,world,context);
+
+  if(context.isAdaptive() && nbChildren > 1) return checkAdaptively(kripke,world,context);
+
   /*
   printf("We are checking : ");
   display();
@@ -302,7 +329,7 @@ unsigned int BooleanOperation::checkBranch(Kripke & kripke, unsigned int world)
     for(unsigned int i = 0; i < nbChildren; i++) {
       
       /* We store the result of the i-th child */
-      result = children[i]->checkBranch(kripke,world); 
+      result = children[i]->check(kripke,world,context); 
 
       /* OK v whatever is OK, so we can return OK directly. */
       if(result == OK) return OK;
@@ -319,10 +346,10 @@ unsigned int BooleanOperation::checkBranch(Kripke & kripke, unsigned int world)
     if(orKO) return KO;
 
     /* If it was not full UNKNOWN, we indicate it with our reason 'UNKONWN OR KO' */
-    if(!fullUnknown) Term::setReason(this,UNKNOWN_OR_KO,world);
+    if(!fullUnknown) context.setReason(this,UNKNOWN_OR_KO,world);
 
     /* If it was full UNKNOWN, we indicate it with our reason 'UNKOWN OR UNKNOWN' */
-    else             Term::setReason(this,UNKNOWN_OR_UNKNOWN,world);
+    else             context.setReason(this,UNKNOWN_OR_UNKNOWN,world);
 
     /* We can now return UNKNOWN. */
 
@@ -332,7 +359,7 @@ unsigned int BooleanOperation::checkBranch(Kripke & kripke, unsigned int world)
     for(unsigned int i =0 ; i < nbChildren; i++) {
       
       /* We store the result of the i-th child */
-      result = children[i]->checkBranch(kripke,world); 
+      result = children[i]->check(kripke,world,context); 
 
       /* KO ^ whatever is KO, so we can return KO directly. */
       if(result == KO) return KO;
@@ -346,9 +373,382 @@ unsigned int BooleanOperation::checkBranch(Kripke & kripke, unsigned int world)
     if(andOK) return OK;
 
     /* If not, it was for sure an UNKNOWN somewhere. */
-    Term::setReason(this,UNKNOWN_AND_UNKNOWN,world);
+    context.setReason(this,UNKNOWN_AND_UNKNOWN,world);
+  }
+
+
+  return UNKNOWN;
+}
+
+/**
+ * @brief This method will compile the BooleanOperation into masks of the valuation rows, if every child is a literal.
+ *
+ * @return true if the BooleanOperation was compiled (its results are then not stored in the cache).
+ */
+bool BooleanOperation::compileLiteralMasks() {
+
+  vector<LiteralMask> compiled;
+
+  for(size_t i = 0; i < children.size(); i++) {
+
+    if(children[i]->getKind() != K_VARIABLE) return false;
+
+    unsigned int id = static_cast<PropositionalVariable*>(children[i])->getId();
+
+    if(id == 0) return false;
+
+    unsigned int shift = ((id - 1) % Kripke::VARIABLES_PER_WORD) << 1;
+    uint32_t word = (id - 1) / Kripke::VARIABLES_PER_WORD;
+
+    /* 01 is assigned positively, 10 negatively: the OK bit of ~p is the KO bit of p. */
+    uint64_t ok = (uint64_t) 1 << (shift + children[i]->isNegated());
+    uint64_t ko = (uint64_t) 1 << (shift + !children[i]->isNegated());
+
+    size_t j = 0;
+    while(j < compiled.size() && compiled[j].word != word) j++;
+
+    if(j == compiled.size()) { LiteralMask empty = { word, 0, 0 }; compiled.push_back(empty); }
+
+    compiled[j].ok |= ok;
+    compiled[j].ko |= ko;
+  }
+
+  masks.swap(compiled);
+  cached = false;
+
+  return true;
+}
+
+/**
+ * @brief This method will check the branch like checkBranch, from the masks of the literals (see BooleanOperation::compileLiteralMasks).
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * @param[in] world the world in which we are checking the satisfiability of the current BooleanOperation.
+ *
+ * @param[in,out] context the context of the check (its reason is set if the result is {KO,UNKNOWN}).
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current BooleanOperation.
+ */
+unsigned int BooleanOperation::checkLiteralMasks(Kripke & kripke, unsigned int world, CheckContext & context) {
+
+  const uint64_t* row = kripke.getRow(world);
+  size_t rowWords = kripke.getRowWords();
+
+  bool someOK = false, everyOK = true;
+  bool someKO = false, everyKO = true;
+
+  for(size_t i = 0; i < masks.size(); i++) {
+
+    /* An atom which does not fit in the rows is not assigned anywhere. */
+    uint64_t bits = (masks[i].word < rowWords) ? row[masks[i].word] : 0;
+
+    someOK  |= (bits & masks[i].ok) != 0;
+    everyOK &= (bits & masks[i].ok) == masks[i].ok;
+    someKO  |= (bits & masks[i].ko) != 0;
+    everyKO &= (bits & masks[i].ko) == masks[i].ko;
+  }
+
+  if(getOperator() == O_OR) {
+
+    if(someOK) return OK;
+
+    /* (KO v KO v ... KO) keeps the reason of its last child. */
+    if(everyKO) { context.setReason(children.back(),NOT_VAR_FOUND_BUT_OPPOSITE,world); return KO; }
+
+    context.setReason(this,someKO ? UNKNOWN_OR_KO : UNKNOWN_OR_UNKNOWN,world);
+    return UNKNOWN;
+  }
+
+  if(someKO) {
+
+    /* The first child which is KO gives its reason. */
+    for(size_t i = 0; i < children.size(); i++) {
+
+      if(kripke.checkLiteral(world,static_cast<PropositionalVariable*>(children[i])->getId(),children[i]->isNegated()) == KO) {
+        context.setReason(children[i],NOT_VAR_FOUND_BUT_OPPOSITE,world);
+        break;
+      }
+    }
+
+    return KO;
+  }
+
+  if(everyOK) return OK;
+
+  context.setReason(this,UNKNOWN_AND_UNKNOWN,world);
+  return UNKNOWN;
+}
+
+/**
+ * @brief This method will check the branch like checkBranch, the children in the order learnt from the previous checks.
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * @param[in] world the world in which we are checking the satisfiability of the current BooleanOperation.
+ *
+ * @param[in,out] context the context of the check (its reason is set if the result is {KO,UNKNOWN}).
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current BooleanOperation.
+ */
+unsigned int BooleanOperation::checkAdaptively(Kripke & kripke, unsigned int world, CheckContext & context) {
+
+  size_t nbChildren = children.size();
+  bool isOr = (getOperator() == O_OR);
+  bool noUnknown = true;
+  bool noKO = true;
+
+  /* The first time, the children are checked in their static order. */
+  if(order.size() != nbChildren) {
+
+    ChildStatistics empty = { 0, 0, 0 };
+
+    order.resize(nbChildren);
+    for(unsigned int i = 0; i < nbChildren; i++) order[i] = i;
+
+    statistics.assign(nbChildren, empty);
+    checksBeforeAdapting = ADAPTIVE_PERIOD;
+  }
+
+  if(--checksBeforeAdapting == 0) adaptOrder();
+
+  bool observed = (checksBeforeAdapting % ADAPTIVE_SAMPLING) == 0;
+
+  for(unsigned int k = 0; k < nbChildren; k++) {
+
+    unsigned int i = order[k];
+    uint64_t before = context.getNbChecks();
+
+    unsigned int result = children[i]->check(kripke,world,context);
+
+    if(observed) {
+      statistics[i].nbChecked++;
+      statistics[i].work += context.getNbChecks() - before;
+    }
+
+    /* OK v whatever is OK, KO ^ whatever is KO. */
+    if(result == (isOr ? OK : KO)) {
+      if(observed) statistics[i].nbDecisive++;
+      return result;
+    }
+
+    if(result == KO)      noKO = false;
+    if(result == UNKNOWN) noUnknown = false;
+  }
+
+  if(noUnknown) return isOr ? KO : OK;
+
+  /* The same reasons as checkBranch. */
+  if(!isOr)      context.setReason(this,UNKNOWN_AND_UNKNOWN,world);
+
+  else if(!noKO) context.setReason(this,UNKNOWN_OR_KO,world);
+
+  else           context.setReason(this,UNKNOWN_OR_UNKNOWN,world);
+
+  return UNKNOWN;
+}
+
+/**
+ * @brief This method will sort the children, cheap and decisive ones first, and forget half of what was observed.
+ */
+void BooleanOperation::adaptOrder() {
+
+  vector<pair<double, uint32_t> > keys(order.size());
+
+  /* The average work per decisive result (Laplace smoothed): the order minimizing the expected work if the children are independent. */
+  for(unsigned int k = 0; k < order.size(); k++) {
+
+    const ChildStatistics & s = statistics[order[k]];
+    double work = (s.work + 1.0) / (s.nbChecked + 1.0);
+    double decisive = (s.nbDecisive + 1.0) / (s.nbChecked + 2.0);
+
+    keys[k] = make_pair(work / decisive, order[k]);
+  }
+
+  stable_sort(keys.begin(), keys.end(), [](const pair<double, uint32_t> & a, const pair<double, uint32_t> & b) { return a.first < b.first; });
+
+  for(unsigned int k = 0; k < order.size(); k++) {
+
+    order[k] = keys[k].second;
+
+    /* The recent checks weigh more, so the order follows the part of the model being checked. */
+    ChildStatistics & s = statistics[order[k]];
+    s.nbChecked >>= 1;
+    s.nbDecisive >>= 1;
+    s.work >>= 1;
+  }
+
+  checksBeforeAdapting = ADAPTIVE_PERIOD;
+}
+
+/**
+ * @brief This method will compute, for every world of the solution kripke, if the BooleanOperation is {OK,KO,UNKNOWN} in it.
+ * 
+ * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * @param[out] labels labels[w] is {OK,KO,UNKNOWN} according to the labels of the children in w.
+ *
+ * @param[in,out] context the context of the check (its cache gets the labels of the Operations, see Term::storeLabels).
+ */
+void BooleanOperation::labelWorlds(Kripke & kripke, WorldSet & labels, CheckContext & context) {
+
+  size_t nbChildren = children.size();
+  WorldSet childLabels;
+
+  /* The first child gives the labels, the other ones are combined with them one by one (64 worlds per word). */
+  children[0]->labelWorlds(kripke,labels,context);
+
+  for(unsigned int i = 1; i < nbChildren; i++) {
+
+    children[i]->labelWorlds(kripke,childLabels,context);
+
+    /* OK v whatever is OK, KO v KO is KO, and the rest is UNKNOWN. */
+    if(getOperator() == O_OR) labels.orWith(childLabels);
+
+    /* KO ^ whatever is KO, OK ^ OK is OK, and the rest is UNKNOWN. */
+    else                      labels.andWith(childLabels);
+  }
+
+  /* The reason is found from the labels once the root is labeled (see Formula::checkFormulaByLabeling). */
+  storeLabels(kripke,labels,context);
+}
+
+/**
+ * \class ChildTask
+ *
+ * @brief The task checking one child of a BooleanOperation, which cancels its siblings if its result decides.
+ */
+class ChildTask : public Task {
+
+public:
+
+    /**
+     * @brief To construct a task, we need the child, where to check it, and the context of the BooleanOperation.
+     *
+     * @param[in] child the child to check.
+     *
+     * @param[in] kripke the Kripke model.
+     *
+     * @param[in] world the world in which the child is checked.
+     *
+     * @param[in] parent the context of the BooleanOperation.
+     *
+     * @param[in] siblings the group of the children of the BooleanOperation.
+     *
+     * @param[in] decisive the result which decides the BooleanOperation (KO for an AND, OK for an OR).
+     */
+    ChildTask(Term* child, Kripke & kripke, unsigned int world, const CheckContext & parent, TaskGroup & siblings, unsigned int decisive)
+      : child(child), kripke(&kripke), world(world), decisive(decisive), result(NOT_YET), context(parent,siblings) { }
+
+    /** @brief The child to check. */
+    Term* child;
+
+    /** @brief The Kripke model. */
+    Kripke* kripke;
+
+    /** @brief The world in which the child is checked. */
+    unsigned int world;
+
+    /** @brief The result which decides the BooleanOperation (KO for an AND, OK for an OR). */
+    unsigned int decisive;
+
+    /** @brief The result of the child (NOT_YET if it was cancelled). */
+    unsigned int result;
+
+    /** @brief The context of the task: its reason, its statistics, and the group of the children. */
+    CheckContext context;
+
+    /** @brief This method will check the child. */
+    virtual void run() {
+
+      result = child->checkInParallel(*kripke,world,context);
+
+      if(result == decisive) context.getGroup()->cancel();
+    }
+};
+
+/**
+ * @brief This method will check the branch in the world world, each child which is not a leaf being a task of the pool of the context.
+ * 
+ * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * @param[in] world the world in which we are checking the satisfiability of the current BooleanOperation.
+ *
+ * @param[in,out] context the context of the current task (with a pool, and a group telling if the result is still needed).
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current BooleanOperation, NOT_YET if the check was cancelled.
+ */
+unsigned int BooleanOperation::checkBranchInParallel(Kripke & kripke, unsigned int world, CheckContext & context) {
+
+  unsigned int decisive = (getOperator() == O_OR) ? OK : KO;
+  unsigned int result;
+  TaskPool & pool = *context.getPool();
+
+  /* The results of the children: KO for an OR (OK for an AND) is neutral. */
+  bool someKO = false;
+  bool someUnknown = false;
+
+  TaskGroup siblings(context.getGroup());
+  vector<ChildTask> tasks;
+
+  for(unsigned int i = 0; i < children.size(); i++) {
+
+    /* The leaves are cheaper to check than to give to another thread (and they come first). */
+    if(children[i]->getNbChildren() == 0) {
+
+      result = children[i]->check(kripke,world,context);
+
+      if(result == decisive) return decisive;
+
+      if(result == KO) someKO = true;
+      if(result == UNKNOWN) someUnknown = true;
+
+      continue;
+    }
+
+    tasks.push_back(ChildTask(children[i],kripke,world,context,siblings,decisive));
   }
 
+  /* The first child is checked by the current thread, the other ones can be stolen. */
+  for(size_t i = 1; i < tasks.size(); i++) pool.spawn(&tasks[i],siblings);
+  if(!tasks.empty()) tasks[0].run();
+  pool.wait(siblings);
+
+  bool cancelled = false;
+
+  for(size_t i = 0; i < tasks.size(); i++) context.addStatistics(tasks[i].context);
+
+  for(size_t i = 0; i < tasks.size(); i++) {
+
+    /* The reason is the one of the child which decided. */
+    if(tasks[i].result == decisive) {
+      context.setReason(tasks[i].context.getReason());
+      return decisive;
+    }
+
+    if(tasks[i].result == KO) someKO = true;
+    if(tasks[i].result == UNKNOWN) someUnknown = true;
+    if(tasks[i].result == NOT_YET) cancelled = true;
+  }
+
+  /* Nothing decided, but a child was cancelled: the BooleanOperation was cancelled from above. */
+  if(cancelled) return NOT_YET;
+
+  /* The same results and reasons as checkBranch, the last child giving its reason to (KO v KO ... v KO). */
+  if(!tasks.empty()) context.setReason(tasks.back().context.getReason());
+
+  if(getOperator() == O_OR) {
+
+    if(!someUnknown) return KO;
+
+    context.setReason(this, someKO ? UNKNOWN_OR_KO : UNKNOWN_OR_UNKNOWN, world);
+
+    return UNKNOWN;
+  }
+
+  if(!someUnknown) return OK;
+
+  context.setReason(this,UNKNOWN_AND_UNKNOWN,world);
 
   return UNKNOWN;
-}
\ No newline at end of file
+}
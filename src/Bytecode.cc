@@ -0,0 +1,255 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+/**
+ * \file Bytecode.cc
+ * @brief Implementation of Bytecode::methods which are not in the Bytecode.h
+ *
+ * @version 1.0
+ */
+
+#include "../include/Bytecode.h"
+#include "../include/BooleanOperation.h"
+#include "../include/ModalOperation.h"
+#include "../include/PropositionalVariable.h"
+#include "../include/BooleanConstant.h"
+
+/**
+ * @brief To construct a Bytecode, we need the root of the simplified formula (with its chains and its ids).
+ *
+ * @param[in] root the root of the formula.
+ */
+Bytecode::Bytecode(Term* root) {
+
+  compile(root);
+}
+
+/**
+ * @brief This method will append the instructions of a Term and of its sub-formulae.
+ *
+ * @param[in] term the Term to compile.
+ */
+void Bytecode::compile(Term* term) {
+
+  uint32_t pc = code.size();
+  Instruction i;
+
+  i.negated = 0;
+  i.arg = 0;
+  i.termId = term->getTermId();
+
+  switch(term->getKind()) {
+
+    case K_VARIABLE:
+      i.opcode = I_LITERAL;
+      i.arg = static_cast<PropositionalVariable*>(term)->getId();
+      i.negated = term->isNegated();
+      break;
+
+    /* Like BooleanConstant::checkBranch, only the value counts. */
+    case K_CONSTANT:
+      i.opcode = static_cast<BooleanConstant*>(term)->getValue() ? I_TRUE : I_FALSE;
+      break;
+
+    case K_MODAL:
+      i.opcode = (static_cast<ModalOperation*>(term)->getOperator() == O_DIAMOND) ? I_DIAMOND : I_BOX;
+      i.arg = SHRINK_CHAIN_OF_WORLDS ? term->getModalTermChainSize() : 0;
+      break;
+
+    /* Like BooleanOperation::checkBranch, everything which is not an OR is an AND. */
+    default:
+      i.opcode = (static_cast<Operation*>(term)->getOperator() == O_OR) ? I_OR : I_AND;
+      i.arg = term->getNbChildren();
+      break;
+  }
+
+  code.push_back(i);
+  terms.push_back(term);
+
+  for(unsigned int c = 0; c < term->getNbChildren(); c++) compile(term->getChild(c));
+
+  code[pc].skip = code.size();
+}
+
+/**
+ * @brief This method will run the instruction pc of a Term without children in the world w.
+ *
+ * @param[in] pc the index of the instruction.
+ *
+ * @param[in] w the world in which the instruction is checked.
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+ *
+ * @param[in,out] context the context of the check.
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the Term of the instruction.
+ */
+inline unsigned int Bytecode::runLeaf(uint32_t pc, unsigned int w, Kripke & kripke, CheckContext & context) const {
+
+  const Instruction & i = code[pc];
+
+  if(i.opcode == I_TRUE)  return OK;
+
+  if(i.opcode == I_FALSE) return KO;
+
+  unsigned int res = kripke.checkLiteral(w,i.arg,i.negated);
+
+  /* The same reasons as PropositionalVariable::checkBranch. */
+  if(res == KO)      context.setReason(terms[pc],NOT_VAR_FOUND_BUT_OPPOSITE,w);
+  if(res == UNKNOWN) context.setReason(terms[pc],NOT_VAR_FOUND_NEITHER_OPPPOSITE,w);
+
+  return res;
+}
+
+/**
+ * @brief This method will run the instruction pc in the world w.
+ *
+ * @param[in] pc the index of the instruction.
+ *
+ * @param[in] w the world in which the instruction is checked.
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+ *
+ * @param[in,out] context the context of the check.
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the Term of the instruction.
+ */
+inline unsigned int Bytecode::run(uint32_t pc, unsigned int w, Kripke & kripke, CheckContext & context) const {
+
+  const Instruction & i = code[pc];
+
+  if(i.opcode < I_AND) return runLeaf(pc,w,kripke,context);
+
+  /* Like Term::check, only the results of the Operations are stored. */
+  if(context.getCache() == NULL) return runOperation(pc,w,kripke,context);
+
+  unsigned int res = context.lookup(i.termId,w,terms[pc]);
+
+  if(res == NOT_YET) {
+    res = runOperation(pc,w,kripke,context);
+    context.getCache()->store(i.termId,w,res);
+  }
+
+  return res;
+}
+
+/**
+ * @brief This method will run the instruction pc of an Operation in the world w (the cache was already looked at).
+ *
+ * @param[in] pc the index of the instruction.
+ *
+ * @param[in] w the world in which the instruction is checked.
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+ *
+ * @param[in,out] context the context of the check.
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the Operation of the instruction.
+ */
+unsigned int Bytecode::runOperation(uint32_t pc, unsigned int w, Kripke & kripke, CheckContext & context) const {
+
+  const Instruction & i = code[pc];
+  unsigned int res;
+
+  if(i.opcode == I_OR || i.opcode == I_AND) {
+
+    bool noUnknown = true;
+    bool noKO = true;
+    uint32_t child = pc + 1;
+
+    /* The children follow each other, skip goes from one to the next. */
+    for(uint32_t c = 0; c < i.arg; c++, child = code[child].skip) {
+
+      /* The leaves are tested here, without any call. */
+      res = (code[child].opcode < I_AND) ? runLeaf(child,w,kripke,context) : run(child,w,kripke,context);
+
+      /* OK v whatever is OK, KO ^ whatever is KO. */
+      if(res == OK && i.opcode == I_OR)  return OK;
+      if(res == KO && i.opcode == I_AND) return KO;
+
+      if(res == KO)      noKO = false;
+      if(res == UNKNOWN) noUnknown = false;
+    }
+
+    if(noUnknown) return (i.opcode == I_OR) ? KO : OK;
+
+    /* The same reasons as BooleanOperation::checkBranch. */
+    if(i.opcode == I_AND) context.setReason(terms[pc],UNKNOWN_AND_UNKNOWN,w);
+
+    else if(!noKO)        context.setReason(terms[pc],UNKNOWN_OR_KO,w);
+
+    else                  context.setReason(terms[pc],UNKNOWN_OR_UNKNOWN,w);
+
+    return UNKNOWN;
+  }
+
+  /* Like ModalOperation::followChain: the chain of modal operators goes on in the next instructions. */
+  uint32_t sub = pc + 1;
+
+  for(uint32_t chain = i.arg; chain > 1 && kripke.getNbConnectedWorlds(w) == 1; chain--) {
+    w = kripke.nextWorld(w);
+    sub++;
+  }
+
+  WorldSpan worldConnected = kripke.getConnectedWorlds(w);
+  unsigned int size = worldConnected.size();
+  bool leaf = code[sub].opcode < I_AND;
+
+  if(i.opcode == I_DIAMOND) {
+
+    for(unsigned int s = 0; s < size; s++) {
+      res = leaf ? runLeaf(sub,worldConnected[s],kripke,context) : run(sub,worldConnected[s],kripke,context);
+      if(res == OK) return OK;
+    }
+
+    context.setReason(terms[pc],NO_EDGE_IS_GIVING_WHAT_WE_SEARCH,w);
+
+    return UNKNOWN;
+  }
+
+  /* The first successor which is not OK gives the result of the box. */
+  for(unsigned int s = 0; s < size; s++) {
+
+    res = leaf ? runLeaf(sub,worldConnected[s],kripke,context) : run(sub,worldConnected[s],kripke,context);
+
+    if(res != OK) return res;
+  }
+
+  return OK;
+}
+
+/**
+ * @brief This method will check if the formula is {OK,KO,UNKNOWN} in the world w.
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+ *
+ * @param[in] w the world in which we are checking the satisfiability of the formula.
+ *
+ * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the formula.
+ */
+unsigned int Bytecode::check(Kripke & kripke, unsigned int w, CheckContext & context) const {
+
+  return run(0,w,kripke,context);
+}
@@ -0,0 +1,148 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+/**
+ * \file CheckCache.cc
+ * @brief Implementation of CheckCache::methods which are not in the CheckCache.h
+ *
+ * @version 1.0
+ */
+
+#include "../include/CheckCache.h"
+
+/** @brief Even with a very small budget, the hashed table has at least this number of buckets. */
+#define MIN_BUCKETS 1024
+
+/**
+ * @brief To construct a cache, we need the size of the problem and how much memory we can use.
+ *
+ * @param[in] nbTerms the number of sub-formulae (the ids are in [0,nbTerms[).
+ *
+ * @param[in] nbWorlds the number of worlds in the Kripke model.
+ *
+ * @param[in] budget the maximum number of bytes that the cache can use.
+ */
+CheckCache::CheckCache(unsigned int nbTerms, unsigned int nbWorlds, size_t budget) {
+
+  this->nbWorlds = nbWorlds;
+  table = NULL;
+  slots = NULL;
+  bucketMask = 0;
+  victim = 0;
+  shared = false;
+  nbEvictions = 0;
+
+  /* 4 entries of 2 bits per byte. */
+  uint64_t denseSize = ((uint64_t) nbTerms * nbWorlds + 3) / 4;
+
+  /* Every entry starts as 0 (not checked yet): calloc gets pages which are only written when a result is stored. */
+  if(denseSize <= budget) table = (uint8_t*) calloc(denseSize + 1, 1);
+
+  dense = (table != NULL);
+
+  if(!dense) {
+
+    /* A bucket is 4 slots of 8 bytes, and we want a power of 2 buckets which fits in the budget (no more than one slot per entry). */
+    uint64_t nbEntries = (uint64_t) nbTerms * nbWorlds;
+    uint64_t nbBuckets = MIN_BUCKETS;
+    while(nbBuckets * 2 * 32 <= budget && nbBuckets * 4 < nbEntries) nbBuckets *= 2;
+
+    /* Without enough memory, fewer buckets (and more evictions). */
+    while((slots = (uint64_t*) calloc(nbBuckets * 4, sizeof(uint64_t))) == NULL && nbBuckets > MIN_BUCKETS) nbBuckets /= 2;
+
+    bucketMask = nbBuckets - 1;
+  }
+}
+
+/**
+ * @brief This method is the destructor, it will just free the table.
+ */
+CheckCache::~CheckCache() {
+
+  free(table);
+  free(slots);
+}
+
+/**
+ * @brief This method will look for a key in the hashed table.
+ *
+ * @param[in] key (term << 32 | world)
+ *
+ * @return the stored result, NOT_YET if the key is not in the table.
+ */
+unsigned int CheckCache::lookupHashed(uint64_t key) {
+
+  uint64_t* bucket = slots + bucketOf(key);
+
+  for(unsigned int i = 0; i < 4; i++) {
+
+    uint64_t slot = __atomic_load_n(&bucket[i], __ATOMIC_RELAXED);
+
+    if(slot == EMPTY_SLOT) break;
+
+    if((slot >> 2) == key) return (slot & 3) ^ 3;
+  }
+
+  return NOT_YET;
+}
+
+/**
+ * @brief This method will store a key in the hashed table, evicting a slot of the bucket if it is full.
+ *
+ * @param[in] key (term << 32 | world)
+ *
+ * @param[in] result {OK,KO,UNKNOWN} the result to store.
+ */
+void CheckCache::storeHashed(uint64_t key, unsigned int result) {
+
+  uint64_t* bucket = slots + bucketOf(key);
+
+  for(unsigned int i = 0; i < 4; i++) {
+
+    uint64_t slot = __atomic_load_n(&bucket[i], __ATOMIC_RELAXED);
+
+    /* Slots are filled from the left, so the first empty one ends the bucket. */
+    if(slot == EMPTY_SLOT || (slot >> 2) == key) {
+      __atomic_store_n(&bucket[i], (key << 2) | (result ^ 3), __ATOMIC_RELAXED);
+      return;
+    }
+  }
+
+  /* The bucket is full, someone has to leave (with several threads, a result may be lost: it will just be checked again). */
+  unsigned int v = shared ? __atomic_fetch_add(&victim, 1, __ATOMIC_RELAXED) : victim++;
+  __atomic_store_n(&bucket[v & 3], (key << 2) | (result ^ 3), __ATOMIC_RELAXED);
+
+  if(shared) __atomic_fetch_add(&nbEvictions, 1, __ATOMIC_RELAXED);
+  else       nbEvictions++;
+}
+
+/**
+ * @brief This method will display the layout and the evictions of the cache as comment lines.
+ *
+ * @param[in] f the FILE* in which we want to display the statistics.
+ */
+void CheckCache::displayStatistics(FILE* f) {
+
+  fprintf(f,"c cache layout    : %s\n", dense ? "dense" : "hashed");
+  fprintf(f,"c cache evictions : %llu\n", (unsigned long long) nbEvictions);
+}
@@ -0,0 +1,120 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+/**
+ * \file CheckContext.cc
+ * @brief Implementation of CheckContext::methods which are not in the CheckContext.h
+ *
+ * @version 1.0
+ */
+
+#include "../include/CheckContext.h"
+#include "../include/PropositionalVariable.h"
+
+/**
+ * @brief This method will give its own reason to a {KO,UNKNOWN} result which was found in the cache.
+ *
+ * The Term of the reason is checked again in its world: its children are still in the cache, so each step goes down the formula,
+ * until the reason is the one that a check without cache would give.
+ *
+ * @param[in] kripke the Kripke model which was checked.
+ */
+void CheckContext::explainCachedReason(Kripke & kripke) {
+
+  /* A reason found in the cache while checking a Term is the one of a strict sub-formula, so it stops. */
+  while(reason.code == RESULT_FROM_CACHE) {
+
+    CheckReason cached = reason;
+
+    /* A Term which gives no reason (a false constant) must not leave the one of the cache. */
+    setReason(NULL,NO_REASON_FOUND,0);
+
+    cached.node->checkBranch(kripke,cached.world,*this);
+  }
+}
+
+/**
+ * @brief according to the code stored and the pointer of the Term*, this method will return an adapted message.
+ * 
+ * @param[in] kripke the Kripke model which was checked (to give the worlds with their id in the solution).
+ *
+ * @return an adapted message according to the code and the Term* of the reason.
+ */
+string CheckContext::getReasonUnchecked(Kripke & kripke) const {
+
+  string message;
+
+    switch(reason.code) {
+
+        case NOT_VAR_FOUND_BUT_OPPOSITE:
+
+            if(reason.node->isNegated()) message.append("~");
+
+            if(reason.node->getKind() == K_VARIABLE)
+                message.append("p" + to_string(static_cast<PropositionalVariable*>(reason.node)->getId()) + " is not in w_" + to_string(kripke.getOriginalId(reason.world)) + " but its negation is !\n");
+
+            break;  
+
+        case NOT_VAR_FOUND_NEITHER_OPPPOSITE:
+
+            if(reason.node->isNegated()) message.append("~");
+
+            if(reason.node->getKind() == K_VARIABLE)
+                message.append("p" + to_string(static_cast<PropositionalVariable*>(reason.node)->getId()) + "is not in w_" + to_string(kripke.getOriginalId(reason.world)) + "(nor its negation) \n");
+            break;
+
+        case NO_EDGE_IS_GIVING_WHAT_WE_SEARCH:
+            message.append("No World accessible by w_" + to_string(kripke.getOriginalId(reason.world)) + " contains what we want...\n");
+            break;
+
+        case UNKNOWN_OR_KO:
+            message.append("At least one part of an OR is wrong in w_" + to_string(kripke.getOriginalId(reason.world))+ " and the rest is UNKNOWN...\n");
+            break;
+
+        case UNKNOWN_OR_UNKNOWN:
+            message.append("All the branches of an OR are UNKNOWN in w_" + to_string(kripke.getOriginalId(reason.world))+ "...\n");
+            break;
+
+        case UNKNOWN_AND_UNKNOWN:
+            message.append("All the branches of an AND are UNKNOWN in w_" + to_string(kripke.getOriginalId(reason.world))+ "...\n");
+            break;
+
+        default:
+            message = "\n";
+            break;
+
+    }
+
+    return message;
+}
+
+/**
+ * @brief This method will display the statistics of the check as comment lines.
+ *
+ * @param[in] f the FILE* in which we want to display the statistics.
+ */
+void CheckContext::displayStatistics(FILE* f) const {
+
+  fprintf(f,"c cache hits      : %llu\n", (unsigned long long) nbHits);
+  fprintf(f,"c cache misses    : %llu\n", (unsigned long long) nbMisses);
+}
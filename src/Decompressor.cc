@@ -0,0 +1,391 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+/**
+ * \file Decompressor.cc
+ * @brief Implementation of Decompressor::methods which are not in the Decompressor.h
+ *
+ * @version 1.0
+ */
+
+#include "../include/Decompressor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef WITH_GZIP
+#include <zlib.h>
+#endif
+
+#ifdef WITH_XZ
+#include <lzma.h>
+#endif
+
+#ifdef WITH_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace std;
+
+/** @brief The compressed data are read, and the decompressed data are written, by blocks of 1 MB. */
+#define DECOMPRESSION_BLOCK (1 << 20)
+
+/**
+ * @brief This function will stop the verifier because the input can not be decompressed.
+ *
+ * @param[in] format the format of the input.
+ */
+static void corrupted(compression_t format) {
+
+  fprintf(stderr,"Problem with the %s input (truncated or corrupted) !\n",Decompressor::getName(format));
+  exit(-2);
+}
+
+/**
+ * @brief This function will read the next compressed bytes: first the bytes already read, then the file descriptor.
+ *
+ * @param[in] in the compressed input.
+ *
+ * @param[in,out] prefix the bytes already read (they are removed once given).
+ *
+ * @param[out] buffer where the bytes are written.
+ *
+ * @param[in] size the size of the buffer.
+ *
+ * @return the number of bytes written in buffer, 0 at the end of the input.
+ */
+static size_t readInput(int in, vector<char> & prefix, char* buffer, size_t size) {
+
+  if(!prefix.empty()) {
+
+    size_t n = min(size, prefix.size());
+    memcpy(buffer, &prefix[0], n);
+    prefix.erase(prefix.begin(), prefix.begin() + n);
+
+    return n;
+  }
+
+  ssize_t n;
+  while((n = read(in, buffer, size)) < 0 && errno == EINTR);
+
+  if(n < 0) {
+    fprintf(stderr,"Problem with the compressed input !\n");
+    exit(-2);
+  }
+
+  return n;
+}
+
+/**
+ * @brief This function will write the decompressed bytes in the pipe (it waits while the parser is behind).
+ *
+ * @param[in] out the write end of the pipe.
+ *
+ * @param[in] data the decompressed bytes.
+ *
+ * @param[in] size the number of bytes.
+ */
+static void writeOutput(int out, const char* data, size_t size) {
+
+  while(size > 0) {
+
+    ssize_t n = write(out, data, size);
+
+    if(n < 0 && errno == EINTR) continue;
+
+    /* The parser stopped reading, nobody needs the rest. */
+    if(n < 0) return;
+
+    data += n;
+    size -= n;
+  }
+}
+
+/**
+ * @brief This function will decompress a gzip input (several gzip members can follow each other).
+ */
+static void gunzip(int in, int out, vector<char> & prefix) {
+
+#ifdef WITH_GZIP
+  vector<char> input(DECOMPRESSION_BLOCK), output(DECOMPRESSION_BLOCK);
+  z_stream z;
+  int ret = Z_OK;
+
+  memset(&z, 0, sizeof(z));
+
+  /* 15 + 32 : the largest window, and a gzip (or zlib) header. */
+  if(inflateInit2(&z, 15 + 32) != Z_OK) corrupted(C_GZIP);
+
+  for(;;) {
+
+    if(z.avail_in == 0) {
+
+      size_t n = readInput(in, prefix, &input[0], input.size());
+      if(n == 0) break;
+
+      z.next_in = (Bytef*) &input[0];
+      z.avail_in = n;
+    }
+
+    z.next_out = (Bytef*) &output[0];
+    z.avail_out = output.size();
+
+    ret = inflate(&z, Z_NO_FLUSH);
+
+    if(ret != Z_OK && ret != Z_STREAM_END) corrupted(C_GZIP);
+
+    writeOutput(out, &output[0], output.size() - z.avail_out);
+
+    if(ret == Z_STREAM_END) inflateReset(&z);
+  }
+
+  if(ret != Z_STREAM_END) corrupted(C_GZIP);
+
+  inflateEnd(&z);
+#else
+  (void) in; (void) out; (void) prefix;
+
+  fprintf(stderr,"Problem with the gzip input: the verifier was built without gzip (make WITH_GZIP=1) !\n");
+  exit(-2);
+#endif
+}
+
+/**
+ * @brief This function will decompress a xz input (several xz streams can follow each other).
+ */
+static void unxz(int in, int out, vector<char> & prefix) {
+
+#ifdef WITH_XZ
+  vector<char> input(DECOMPRESSION_BLOCK), output(DECOMPRESSION_BLOCK);
+  lzma_stream s = LZMA_STREAM_INIT;
+  lzma_action action = LZMA_RUN;
+
+  if(lzma_stream_decoder(&s, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK) corrupted(C_XZ);
+
+  for(;;) {
+
+    if(s.avail_in == 0 && action == LZMA_RUN) {
+
+      size_t n = readInput(in, prefix, &input[0], input.size());
+      if(n == 0) action = LZMA_FINISH;
+
+      s.next_in = (const uint8_t*) &input[0];
+      s.avail_in = n;
+    }
+
+    s.next_out = (uint8_t*) &output[0];
+    s.avail_out = output.size();
+
+    lzma_ret ret = lzma_code(&s, action);
+
+    writeOutput(out, &output[0], output.size() - s.avail_out);
+
+    if(ret == LZMA_STREAM_END) break;
+
+    if(ret != LZMA_OK) corrupted(C_XZ);
+  }
+
+  lzma_end(&s);
+#else
+  (void) in; (void) out; (void) prefix;
+
+  fprintf(stderr,"Problem with the xz input: the verifier was built without xz (make WITH_XZ=1) !\n");
+  exit(-2);
+#endif
+}
+
+/**
+ * @brief This function will decompress a zstd input (several zstd frames can follow each other).
+ */
+static void unzstd(int in, int out, vector<char> & prefix) {
+
+#ifdef WITH_ZSTD
+  vector<char> input(DECOMPRESSION_BLOCK), output(DECOMPRESSION_BLOCK);
+  ZSTD_DStream* z = ZSTD_createDStream();
+  size_t ret = 0;
+  size_t n;
+
+  ZSTD_initDStream(z);
+
+  while((n = readInput(in, prefix, &input[0], input.size())) != 0) {
+
+    ZSTD_inBuffer inBuffer = { &input[0], n, 0 };
+    ZSTD_outBuffer outBuffer;
+
+    /* When the output is full, there may be more to flush even if the input is consumed. */
+    do {
+
+      outBuffer.dst = &output[0];
+      outBuffer.size = output.size();
+      outBuffer.pos = 0;
+
+      ret = ZSTD_decompressStream(z, &outBuffer, &inBuffer);
+
+      if(ZSTD_isError(ret)) corrupted(C_ZSTD);
+
+      writeOutput(out, &output[0], outBuffer.pos);
+
+    } while(inBuffer.pos < inBuffer.size || outBuffer.pos == outBuffer.size);
+  }
+
+  /* 0 means that the last frame is complete. */
+  if(ret != 0) corrupted(C_ZSTD);
+
+  ZSTD_freeDStream(z);
+#else
+  (void) in; (void) out; (void) prefix;
+
+  fprintf(stderr,"Problem with the zstd input: the verifier was built without zstd (make WITH_ZSTD=1) !\n");
+  exit(-2);
+#endif
+}
+
+/**
+ * @brief This function will copy an input which is not compressed (when it can not be read again from the beginning).
+ */
+static void copy(int in, int out, vector<char> & prefix) {
+
+  vector<char> buffer(DECOMPRESSION_BLOCK);
+  size_t n;
+
+  while((n = readInput(in, prefix, &buffer[0], buffer.size())) != 0) writeOutput(out, &buffer[0], n);
+}
+
+/**
+ * @brief This function is the body of the thread: it decompresses 'in' into 'out', then closes 'out'.
+ */
+static void decompress(int in, int out, compression_t format, vector<char> prefix) {
+
+  switch(format) {
+
+    case C_GZIP: gunzip(in, out, prefix); break;
+    case C_XZ:   unxz(in, out, prefix);   break;
+    case C_ZSTD: unzstd(in, out, prefix); break;
+    default:     copy(in, out, prefix);   break;
+  }
+
+  /* The parser reads the end of the data. */
+  close(out);
+}
+
+/**
+ * @brief This method will recognize the format of some data by its first bytes.
+ *
+ * @param[in] data the first bytes.
+ *
+ * @param[in] size the number of bytes available (MAGIC_SIZE are enough).
+ *
+ * @return the format of the data, C_NONE if it is not compressed.
+ */
+compression_t Decompressor::detect(const char* data, size_t size) {
+
+  if(size >= 2 && !memcmp(data, "\x1F\x8B", 2)) return C_GZIP;
+
+  if(size >= 6 && !memcmp(data, "\xFD" "7zXZ\x00", 6)) return C_XZ;
+
+  if(size >= 4 && !memcmp(data, "\x28\xB5\x2F\xFD", 4)) return C_ZSTD;
+
+  return C_NONE;
+}
+
+/**
+ * @brief This method will start the decompression of the file descriptor 'fd' on a new thread.
+ *
+ * @param[in] fd the compressed input (the caller keeps it, and can close it once the decompressed data are read until the end).
+ *
+ * @param[in] format the format of the input.
+ *
+ * @param[in] prefix the first bytes of the input, already read from fd.
+ *
+ * @param[in] prefixSize the number of bytes already read.
+ *
+ * @return the file descriptor from which the decompressed data can be read.
+ */
+int Decompressor::start(int fd, compression_t format, const char* prefix, size_t prefixSize) {
+
+  int fds[2];
+
+  if(pipe(fds) < 0) {
+    fprintf(stderr,"Problem with the creation of a pipe !\n");
+    exit(-2);
+  }
+
+#ifdef F_SETPIPE_SZ
+  /* A larger pipe lets the thread decompress a whole block while the parser works. */
+  fcntl(fds[1], F_SETPIPE_SZ, DECOMPRESSION_BLOCK);
+#endif
+
+  thread(decompress, fd, fds[1], format, vector<char>(prefix, prefix + prefixSize)).detach();
+
+  return fds[0];
+}
+
+/**
+ * @brief This method will open a file which may be compressed, to read it with the stdio functions.
+ *
+ * @param[in] path the path of the file.
+ *
+ * @return the FILE* of the (decompressed) data, NULL if the file can not be opened.
+ */
+FILE* Decompressor::openFile(const char* path) {
+
+  int fd = open(path, O_RDONLY);
+  char magic[MAGIC_SIZE];
+  size_t size = 0;
+  ssize_t n;
+
+  if(fd < 0) return NULL;
+
+  while(size < MAGIC_SIZE && (n = read(fd, magic + size, MAGIC_SIZE - size)) > 0) size += n;
+
+  compression_t format = detect(magic, size);
+
+  /* A regular file which is not compressed is read directly, from the beginning. */
+  if(format == C_NONE && lseek(fd, 0, SEEK_SET) == 0) return fdopen(fd, "r");
+
+  return fdopen(start(fd, format, magic, size), "r");
+}
+
+/**
+ * @brief This method will return the name of a format.
+ *
+ * @param[in] format the format.
+ *
+ * @return "gzip", "xz", "zstd" or "none".
+ */
+const char* Decompressor::getName(compression_t format) {
+
+  switch(format) {
+
+    case C_GZIP: return "gzip";
+    case C_XZ:   return "xz";
+    case C_ZSTD: return "zstd";
+    default:     return "none";
+  }
+}
@@ -22,6 +22,17 @@
 ***************************************************************************************************/
 
 #include "../include/Formula.h"
+#include "../include/TaskPool.h"
+#include "../include/IterativeChecker.h"
+#include "../include/Bytecode.h"
+#include "../include/NativeChecker.h"
+#include "../include/FormulaStore.h"
+#include "../include/PropositionalVariable.h"
+#include "../include/BooleanConstant.h"
+
+#include <unordered_map>
+#include <unordered_set>
+#include <math.h>
 
 /**
  * \file Formula.cc
@@ -56,9 +67,13 @@ Formula *Formula::instance = new Formula();
  *
  * [r1]a ^ [r1]b <=> [r1](a ^ b)
  *
- * Then we will order children of each Term. 
+ * Then we will order children of each Term, share the sub-formulae appearing several times, and compile the clauses of literals.
+ *
+ * @param[in] share false to keep every sub-formula as it is written (see Formula::shareSubformulas).
+ *
+ * @param[in] clauses false to check the clauses of literals child by child (see Formula::compileClauses).
  */
-void Formula::simplify() {
+void Formula::simplify(bool share, bool clauses) {
   
   if(root != NULL) {
 
@@ -71,10 +86,337 @@ void Formula::simplify() {
     /* This method will apply the BoxLifting rules on every part of the formula. */
     root->boxLifting();
 
-    /* This method will sort children according if they are easy to check or not. */
+    /* The children are checked in the order in which they were created (see Formula::orderChildrenByCost with -o). */
     root->orderChildren();
+
+    /* The equal sub-formulae become one Term, so they are checked once per world. */
+    if(share) shareSubformulas();
+
+    /* The clauses and the cubes of literals are checked in the valuation rows. */
+    if(clauses) compileClauses();
+  }
+
+}
+
+/**
+ * \struct TermKeyHash
+ *
+ * @brief The hash of the key of a Term (see termKey).
+ */
+struct TermKeyHash {
+
+  size_t operator()(const vector<uintptr_t> & key) const {
+
+    uint64_t h = 14695981039346656037ULL;
+
+    for(size_t i = 0; i < key.size(); i++) h = (h ^ key[i]) * 1099511628211ULL;
+
+    return h;
+  }
+};
+
+/** @brief The Terms already met, by key. */
+typedef unordered_map<vector<uintptr_t>, Term*, TermKeyHash> TermTable;
+
+/**
+ * @brief This function will return what makes a Term equal to another one: its kind, its polarity, its operator or its atom, and its children.
+ *
+ * @param[in] term the Term (its children are already shared, so they are compared by address).
+ *
+ * @return the key of the Term.
+ */
+static vector<uintptr_t> termKey(Term* term) {
+
+  vector<uintptr_t> key;
+
+  key.push_back(term->getKind());
+  key.push_back(term->isNegated());
+
+  switch(term->getKind()) {
+
+    case K_VARIABLE: key.push_back(static_cast<PropositionalVariable*>(term)->getId()); break;
+
+    case K_CONSTANT: key.push_back(static_cast<BooleanConstant*>(term)->getValue()); break;
+
+    default:
+      key.push_back(static_cast<Operation*>(term)->getOperator());
+      for(unsigned int i = 0; i < term->getNbChildren(); i++) key.push_back((uintptr_t) term->getChild(i));
+      break;
+  }
+
+  return key;
+}
+
+/**
+ * @brief This function will share the sub-formulae of a Term, then return the Term of the table equal to it (the Term itself if it is the first one).
+ *
+ * The children keep their order: two Operations with the same children in another order are not merged, their checks stop at different places.
+ *
+ * @param[in] term the Term.
+ *
+ * @param[in,out] table the Terms already met.
+ *
+ * @param[in,out] nbShared increased for each Term replaced by an equal one.
+ *
+ * @return the Term to use instead of term.
+ */
+static Term* shareTerm(Term* term, TermTable & table, unsigned int & nbShared) {
+
+  for(unsigned int i = 0; i < term->getNbChildren(); i++) term->setChild(i, shareTerm(term->getChild(i), table, nbShared));
+
+  pair<TermTable::iterator, bool> entry = table.insert(make_pair(termKey(term), term));
+
+  if(entry.second) return term;
+
+  /* Only its father knew this Term, and it will use the one of the table. */
+  delete term;
+  nbShared++;
+
+  return entry.first->second;
+}
+
+/**
+ * @brief This method will make every sub-formula appearing several times one Term, shared by its fathers.
+ *
+ * The formula becomes a DAG: the father of a shared Term is only one of them.
+ *
+ * @return the number of Terms replaced by an equal one.
+ */
+unsigned int Formula::shareSubformulas() {
+
+  TermTable table;
+
+  nbShared = 0;
+
+  if(root != NULL) root = shareTerm(root, table, nbShared);
+
+  return nbShared;
+}
+
+/**
+ * @brief This function will compile every clause and cube of literals of a Term (see BooleanOperation::compileLiteralMasks).
+ *
+ * @param[in] term the Term.
+ *
+ * @param[in,out] visited the Terms already met (a shared Term is compiled once).
+ *
+ * @param[in,out] nbCompiled increased for each BooleanOperation compiled.
+ */
+static void compileTerm(Term* term, unordered_set<Term*> & visited, unsigned int & nbCompiled) {
+
+  if(!visited.insert(term).second) return;
+
+  for(unsigned int i = 0; i < term->getNbChildren(); i++) compileTerm(term->getChild(i), visited, nbCompiled);
+
+  if(term->getKind() == K_BOOLEAN && static_cast<BooleanOperation*>(term)->compileLiteralMasks()) nbCompiled++;
+}
+
+/**
+ * @brief This method will compile every BooleanOperation whose children are all literals into masks of the valuation rows.
+ *
+ * The other BooleanOperations (over a modal operator, or over another BooleanOperation) check their children one by one.
+ *
+ * @return the number of BooleanOperations compiled.
+ */
+unsigned int Formula::compileClauses() {
+
+  unordered_set<Term*> visited;
+
+  nbCompiled = 0;
+
+  if(root != NULL) compileTerm(root, visited, nbCompiled);
+
+  return nbCompiled;
+}
+
+/**
+ * \struct CostEstimate
+ *
+ * @brief What checking a Term in a world of the model is expected to give, and to cost.
+ */
+struct CostEstimate {
+
+  /** @brief The probability that the Term is OK. */
+  double pOK;
+
+  /** @brief The probability that the Term is KO. */
+  double pKO;
+
+  /** @brief The expected number of Terms checked. */
+  double cost;
+};
+
+/**
+ * \struct ModelStatistics
+ *
+ * @brief What the ordering by cost knows about the model, and the estimates already computed.
+ */
+struct ModelStatistics {
+
+  /** @brief pTrue[v] (pFalse[v]) is the fraction of the worlds where p'v' is assigned positively (negatively). */
+  vector<double> pTrue, pFalse;
+
+  /** @brief The average number of successors of a world. */
+  double degree;
+
+  /** @brief The estimate of each Term already ordered (a shared Term is ordered once). */
+  unordered_map<Term*, CostEstimate> estimates;
+};
+
+/** @brief A probability below this one is this one, so the ratio cost / probability stays finite. */
+#define MIN_PROBABILITY 1e-6
+
+/**
+ * @brief This function will sort the children of every BooleanOperation under a Term by cost, and return the estimate of the Term.
+ *
+ * The children of an AND are sorted by cost / P(KO), the ones of an OR by cost / P(OK): this order minimizes
+ * the expected cost of a check which stops at the first decisive child, if the children are independent.
+ *
+ * @param[in] term the Term.
+ *
+ * @param[in,out] stats the statistics of the model, and the estimates already computed.
+ *
+ * @return the estimate of the Term in an average world.
+ */
+static CostEstimate orderByCost(Term* term, ModelStatistics & stats) {
+
+  unordered_map<Term*, CostEstimate>::iterator found = stats.estimates.find(term);
+
+  if(found != stats.estimates.end()) return found->second;
+
+  CostEstimate e = { 0.0, 0.0, 1.0 };
+
+  switch(term->getKind()) {
+
+    case K_VARIABLE: {
+
+      unsigned int value = static_cast<PropositionalVariable*>(term)->getId();
+
+      /* An atom which is not in the model is never assigned. */
+      if(value < stats.pTrue.size()) {
+        e.pOK = term->isNegated() ? stats.pFalse[value] : stats.pTrue[value];
+        e.pKO = term->isNegated() ? stats.pTrue[value] : stats.pFalse[value];
+      }
+      break;
+    }
+
+    case K_CONSTANT:
+      if(static_cast<BooleanConstant*>(term)->getValue()) e.pOK = 1.0;
+      else                                                 e.pKO = 1.0;
+      break;
+
+    case K_BOOLEAN: {
+
+      bool isOr = static_cast<Operation*>(term)->getOperator() == O_OR;
+      vector<pair<double, pair<Term*, CostEstimate> > > children;
+
+      for(unsigned int i = 0; i < term->getNbChildren(); i++) {
+
+        CostEstimate c = orderByCost(term->getChild(i), stats);
+        double decisive = max(isOr ? c.pOK : c.pKO, MIN_PROBABILITY);
+
+        children.push_back(make_pair(c.cost / decisive, make_pair(term->getChild(i), c)));
+      }
+
+      /* On a tie, the literals first and the modal operators last (see operator<), then the order of Term::orderChildren. */
+      stable_sort(children.begin(), children.end(),
+                  [](const pair<double, pair<Term*, CostEstimate> > & a, const pair<double, pair<Term*, CostEstimate> > & b) {
+                    return a.first < b.first || (a.first == b.first && *a.second.first < *b.second.first);
+                  });
+
+      /* The probability that every child checked so far was not decisive, and the probability that each was the neutral value. */
+      double notDecided = 1.0, allNeutral = 1.0;
+
+      e.cost = 1.0;
+
+      for(unsigned int i = 0; i < children.size(); i++) {
+
+        const CostEstimate & c = children[i].second.second;
+
+        term->setChild(i, children[i].second.first);
+
+        e.cost += notDecided * c.cost;
+        notDecided *= 1.0 - (isOr ? c.pOK : c.pKO);
+        allNeutral *= isOr ? c.pKO : c.pOK;
+      }
+
+      e.pOK = isOr ? 1.0 - notDecided : allNeutral;
+      e.pKO = isOr ? allNeutral : 1.0 - notDecided;
+      break;
+    }
+
+    default: {
+
+      CostEstimate c = orderByCost(term->getChild(0), stats);
+      double d = stats.degree;
+      bool isDiamond = static_cast<Operation*>(term)->getOperator() == O_DIAMOND;
+
+      /* A diamond goes on while its successors are not OK, a box while they are OK. */
+      double goOn = isDiamond ? 1.0 - c.pOK : c.pOK;
+      double visited = (goOn < 1.0) ? (1.0 - pow(goOn, d)) / (1.0 - goOn) : d;
+
+      e.cost = 1.0 + visited * c.cost;
+
+      if(isDiamond) e.pOK = 1.0 - pow(goOn, d);
+
+      else {
+        e.pOK = pow(goOn, d);
+        e.pKO = (goOn < 1.0) ? (1.0 - e.pOK) * c.pKO / (1.0 - goOn) : 0.0;
+      }
+      break;
+    }
+  }
+
+  stats.estimates[term] = e;
+
+  return e;
+}
+
+/**
+ * @brief This method will sort the children of every BooleanOperation by their expected cost in the Kripke model.
+ *
+ * The probability that a literal is OK (KO) is the fraction of the worlds where it is (its opposite is) assigned,
+ * a modal operator checks the average number of successors, and a child is checked first if it is cheap and likely to stop the check.
+ *
+ * @param[in] kripke the Kripke model which will be checked.
+ */
+void Formula::orderChildrenByCost(Kripke & kripke) {
+
+  if(root == NULL || kripke.getNbWorlds() == 0) return;
+
+  ModelStatistics stats;
+  vector<unsigned int> nbTrue, nbFalse;
+
+  kripke.countAssignations(nbTrue, nbFalse);
+
+  stats.pTrue.resize(nbTrue.size());
+  stats.pFalse.resize(nbFalse.size());
+
+  for(size_t v = 0; v < nbTrue.size(); v++) {
+    stats.pTrue[v] = (double) nbTrue[v] / kripke.getNbWorlds();
+    stats.pFalse[v] = (double) nbFalse[v] / kripke.getNbWorlds();
   }
 
+  stats.degree = (double) kripke.getNbEdges() / kripke.getNbWorlds();
+
+  orderByCost(root, stats);
+}
+
+/**
+ * @brief This method will give an id to every Term of the formula (once to a shared Term).
+ *
+ * @return the number of Terms in the formula.
+ */
+unsigned int Formula::setTermIds() {
+
+  nbTerms = 0;
+
+  if(root != NULL) {
+    root->clearTermIds();
+    root->setTermIds(nbTerms);
+  }
+
+  return nbTerms;
 }
 
 /**
@@ -82,16 +424,186 @@ void Formula::simplify() {
  *
  * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
  *
+ * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+ *
  * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
  */
-unsigned int Formula::checkFormula(Kripke & kripke) {
+unsigned int Formula::checkFormula(Kripke & kripke, CheckContext & context) {
 
   if(root != NULL) {
 
     /* To check a Formula, it means to check the Root in w0, the only world for sure existing. */
-    return root->checkBranch(kripke,0);
+    return root->check(kripke,0,context);
   }
 
   /* If there is no ROOT, it is difficult to check a formula. */
   return UNKNOWN;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief This method will check the formula according to a Kripke model, by labeling every world bottom-up.
+ *
+ * Every sub-formula is labeled {OK,KO,UNKNOWN} in every world, from the leaves to the root.
+ * It takes O(|formula| x (|Worlds| + |Edges|)) time, whatever the shape of the Kripke model.
+ *
+ * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+ *
+ * @param[in,out] context the context of the check (the reason of a {KO,UNKNOWN} result).
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+ */
+unsigned int Formula::checkFormulaByLabeling(Kripke & kripke, CheckContext & context) {
+
+  if(root != NULL && kripke.getNbWorlds() > 0) {
+
+    WorldSet labels;
+
+    root->labelWorlds(kripke,labels,context);
+
+    /* The formula is checked in w0, like with checkFormula. */
+    unsigned int result = labels.get(0);
+
+    /* The reason is the one of checkBranch in w0: the sub-formulae give it their labels (see Term::storeLabels). */
+    if(result != OK) root->checkBranch(kripke,0,context);
+
+    return result;
+  }
+
+  return UNKNOWN;
+}
+
+/**
+ * @brief This method will check the formula according to a Kripke model, top-down, with several threads.
+ *
+ * The children of a BooleanOperation and the successors of a ModalOperation are checked by tasks,
+ * which the threads steal from each other, and a decisive result cancels the tasks which are not needed anymore.
+ *
+ * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+ *
+ * @param[in] nbThreads the number of threads (the calling one included).
+ *
+ * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+ */
+unsigned int Formula::checkFormulaInParallel(Kripke & kripke, unsigned int nbThreads, CheckContext & context) {
+
+  if(root != NULL && kripke.getNbWorlds() > 0) {
+
+    TaskPool pool(nbThreads);
+    TaskGroup group;
+    CheckContext parallel(context.getCache(),&pool,&group);
+
+    /* Nothing cancels the root, so its result is never NOT_YET. */
+    unsigned int res = root->checkInParallel(kripke,0,parallel);
+
+    context.setReason(parallel.getReason());
+    context.addStatistics(parallel);
+
+    return res;
+  }
+
+  return UNKNOWN;
+}
+
+/**
+ * @brief This method will check the formula according to a Kripke model, top-down, without any recursive call.
+ *
+ * Same results as checkFormula, but the Operations being checked are frames of a stack stored in the heap (see IterativeChecker),
+ * so a formula with a very large modal depth can not overflow the native stack.
+ *
+ * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+ *
+ * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+ */
+unsigned int Formula::checkFormulaIteratively(Kripke & kripke, CheckContext & context) {
+
+  if(root != NULL) {
+
+    IterativeChecker checker(kripke,context);
+
+    return checker.check(root,0);
+  }
+
+  return UNKNOWN;
+}
+
+/**
+ * @brief This method will check the formula according to a Kripke model, top-down, once compiled into an array of instructions.
+ *
+ * Same results as checkFormula, but the interpreter of the Bytecode has no virtual call and reads the formula contiguously.
+ *
+ * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+ *
+ * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+ */
+unsigned int Formula::checkFormulaCompiled(Kripke & kripke, CheckContext & context) {
+
+  if(root != NULL) {
+
+    Bytecode program(root);
+
+    return program.check(kripke,0,context);
+  }
+
+  return UNKNOWN;
+}
+
+/**
+ * @brief This method will check the formula according to a Kripke model, top-down, once compiled into machine code.
+ *
+ * Same results as checkFormula, the formula being translated into C++ and built into a shared object (see NativeChecker).
+ * If the shared object can not be built, the formula is checked by the Bytecode.
+ *
+ * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+ *
+ * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+ */
+unsigned int Formula::checkFormulaNatively(Kripke & kripke, CheckContext & context) {
+
+  if(root != NULL) {
+
+    NativeChecker checker(root);
+
+    if(checker.load()) return checker.check(kripke,0,context);
+
+    fprintf(stderr,"c the native checker can not be built, the bytecode is used\n");
+
+    return checkFormulaCompiled(kripke,context);
+  }
+
+  return UNKNOWN;
+}
+
+/**
+ * @brief This method will check the formula according to a Kripke model, top-down, once stored as a struct of arrays.
+ *
+ * Same results as checkFormula, the nodes being read from the arrays of a FormulaStore (Formula::setTermIds has to be called before).
+ *
+ * @param[in] kripke The Kripke model which is maybe a solution of the Formula.
+ *
+ * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+ *
+ * @param[in] verbose true to display the size of the store.
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiability of the Formula with the Kripke model.
+ */
+unsigned int Formula::checkFormulaFromStore(Kripke & kripke, CheckContext & context, bool verbose) {
+
+  if(root != NULL) {
+
+    FormulaStore store(root,nbTerms);
+
+    if(verbose) printf("c formula store : %zu nodes, %zu bytes\n",store.size(),store.getMemory());
+
+    return store.check(kripke,0,context);
+  }
+
+  return UNKNOWN;
+}
@@ -0,0 +1,274 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+
+/**
+ * \file FormulaStore.cc
+ * @brief Implementation of FormulaStore::methods which are not in the FormulaStore.h
+ *
+ * @version 1.0
+ */
+
+#include "../include/FormulaStore.h"
+#include "../include/BooleanOperation.h"
+#include "../include/ModalOperation.h"
+#include "../include/PropositionalVariable.h"
+#include "../include/BooleanConstant.h"
+
+/**
+ * @brief To construct a FormulaStore, we need the root of the simplified formula and the number of ids given.
+ *
+ * @param[in] root the root of the formula (with its chains and its ids).
+ *
+ * @param[in] nbTerms the number of ids given by Term::setTermIds.
+ */
+FormulaStore::FormulaStore(Term* root, unsigned int nbTerms) {
+
+  kinds.resize(nbTerms);
+  operators.resize(nbTerms, O_DOESNT_EXIST);
+  negated.resize(nbTerms, 0);
+  operands.resize(nbTerms, 0);
+  nbChildren.resize(nbTerms, 0);
+  chainSizes.resize(nbTerms, 0);
+  terms.resize(nbTerms, NULL);
+
+  this->root = root->getTermId();
+
+  add(root);
+}
+
+/**
+ * @brief This method will return the memory used by the arrays (without the Terms kept for the reasons).
+ *
+ * @return the number of bytes of the store.
+ */
+size_t FormulaStore::getMemory() const {
+
+  return kinds.size() * (3 * sizeof(uint8_t) + 3 * sizeof(uint32_t)) + children.size() * sizeof(uint32_t);
+}
+
+/**
+ * @brief This method will fill the arrays for a Term and its sub-formulae.
+ *
+ * @param[in] term the Term to store.
+ */
+void FormulaStore::add(Term* term) {
+
+  uint32_t n = term->getTermId();
+
+  /* A sub-formula shared by several Terms has only one id. */
+  if(terms[n] != NULL) return;
+
+  terms[n] = term;
+  kinds[n] = term->getKind();
+  chainSizes[n] = term->getModalTermChainSize();
+
+  switch(term->getKind()) {
+
+    case K_VARIABLE:
+      operands[n] = static_cast<PropositionalVariable*>(term)->getId();
+      negated[n] = term->isNegated();
+      return;
+
+    case K_CONSTANT:
+      operands[n] = static_cast<BooleanConstant*>(term)->getValue();
+      return;
+
+    default:
+      break;
+  }
+
+  uint32_t first = children.size();
+  uint32_t size = term->getNbChildren();
+
+  operators[n] = static_cast<Operation*>(term)->getOperator();
+  operands[n] = first;
+  nbChildren[n] = size;
+
+  children.resize(first + size);
+
+  for(uint32_t c = 0; c < size; c++) {
+    children[first + c] = term->getChild(c)->getTermId();
+    add(term->getChild(c));
+  }
+}
+
+/**
+ * @brief This method will check the node n, which has no children, in the world w.
+ *
+ * @param[in] n the id of the node.
+ *
+ * @param[in] w the world in which the node is checked.
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+ *
+ * @param[in,out] context the context of the check.
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the node.
+ */
+inline unsigned int FormulaStore::runLeaf(uint32_t n, unsigned int w, Kripke & kripke, CheckContext & context) const {
+
+  /* Like BooleanConstant::checkBranch, only the value counts. */
+  if(kinds[n] == K_CONSTANT) return operands[n] ? OK : KO;
+
+  unsigned int res = kripke.checkLiteral(w,operands[n],negated[n]);
+
+  /* The same reasons as PropositionalVariable::checkBranch. */
+  if(res == KO)      context.setReason(terms[n],NOT_VAR_FOUND_BUT_OPPOSITE,w);
+  if(res == UNKNOWN) context.setReason(terms[n],NOT_VAR_FOUND_NEITHER_OPPPOSITE,w);
+
+  return res;
+}
+
+/**
+ * @brief This method will check the node n in the world w.
+ *
+ * @param[in] n the id of the node.
+ *
+ * @param[in] w the world in which the node is checked.
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+ *
+ * @param[in,out] context the context of the check.
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the node.
+ */
+inline unsigned int FormulaStore::run(uint32_t n, unsigned int w, Kripke & kripke, CheckContext & context) const {
+
+  if(kinds[n] < K_BOOLEAN) return runLeaf(n,w,kripke,context);
+
+  /* Like Term::check, only the results of the Operations are stored. */
+  if(context.getCache() == NULL) return runOperation(n,w,kripke,context);
+
+  unsigned int res = context.lookup(n,w,terms[n]);
+
+  if(res == NOT_YET) {
+    res = runOperation(n,w,kripke,context);
+    context.getCache()->store(n,w,res);
+  }
+
+  return res;
+}
+
+/**
+ * @brief This method will check the node n of an Operation in the world w (the cache was already looked at).
+ *
+ * @param[in] n the id of the node.
+ *
+ * @param[in] w the world in which the node is checked.
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+ *
+ * @param[in,out] context the context of the check.
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the node.
+ */
+unsigned int FormulaStore::runOperation(uint32_t n, unsigned int w, Kripke & kripke, CheckContext & context) const {
+
+  const uint32_t* child = &children[0] + operands[n];
+  unsigned int op = operators[n];
+  unsigned int res;
+
+  switch(kinds[n]) {
+
+    case K_BOOLEAN: {
+
+      bool noUnknown = true;
+      bool noKO = true;
+
+      for(uint32_t c = 0; c < nbChildren[n]; c++) {
+
+        res = run(child[c],w,kripke,context);
+
+        /* OK v whatever is OK, KO ^ whatever is KO. */
+        if(res == OK && op == O_OR) return OK;
+        if(res == KO && op != O_OR) return KO;
+
+        if(res == KO)      noKO = false;
+        if(res == UNKNOWN) noUnknown = false;
+      }
+
+      if(noUnknown) return (op == O_OR) ? KO : OK;
+
+      /* The same reasons as BooleanOperation::checkBranch. */
+      if(op != O_OR) context.setReason(terms[n],UNKNOWN_AND_UNKNOWN,w);
+
+      else if(!noKO) context.setReason(terms[n],UNKNOWN_OR_KO,w);
+
+      else           context.setReason(terms[n],UNKNOWN_OR_UNKNOWN,w);
+
+      return UNKNOWN;
+    }
+
+    default: {
+
+      /* Like ModalOperation::followChain: each world followed goes one node deeper in the chain. */
+      uint32_t sub = child[0];
+
+      if(SHRINK_CHAIN_OF_WORLDS) {
+        for(uint32_t chain = chainSizes[n]; chain > 1 && kripke.getNbConnectedWorlds(w) == 1; chain--) {
+          w = kripke.nextWorld(w);
+          sub = children[operands[sub]];
+        }
+      }
+
+      WorldSpan worldConnected = kripke.getConnectedWorlds(w);
+      unsigned int size = worldConnected.size();
+
+      if(op == O_DIAMOND) {
+
+        for(unsigned int s = 0; s < size; s++) if(run(sub,worldConnected[s],kripke,context) == OK) return OK;
+
+        context.setReason(terms[n],NO_EDGE_IS_GIVING_WHAT_WE_SEARCH,w);
+
+        return UNKNOWN;
+      }
+
+      /* The first successor which is not OK gives the result of the box. */
+      for(unsigned int s = 0; s < size; s++) {
+
+        res = run(sub,worldConnected[s],kripke,context);
+
+        if(res != OK) return res;
+      }
+
+      return OK;
+    }
+  }
+}
+
+/**
+ * @brief This method will check if the formula is {OK,KO,UNKNOWN} in the world w.
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the formula.
+ *
+ * @param[in] w the world in which we are checking the satisfiability of the formula.
+ *
+ * @param[in,out] context the context of the check (its cache, and the reason of a {KO,UNKNOWN} result).
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the formula.
+ */
+unsigned int FormulaStore::check(Kripke & kripke, unsigned int w, CheckContext & context) const {
+
+  return run(root,w,kripke,context);
+}
@@ -0,0 +1,183 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+/**
+ * \file IterativeChecker.cc
+ * @brief Implementation of IterativeChecker::methods which are not in the IterativeChecker.h
+ *
+ * @version 1.0
+ */
+
+#include "../include/IterativeChecker.h"
+
+/**
+ * @brief This method will check if the Term is {OK,KO,UNKNOWN} in the world w.
+ *
+ * @param[in] term the Term to check.
+ *
+ * @param[in] w the world in which we are checking the satisfiability of the Term.
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the Term.
+ */
+unsigned int IterativeChecker::check(Term* term, unsigned int w) {
+
+  CheckCache* cache = context.getCache();
+
+  frames.clear();
+
+  unsigned int res = enter(term,w);
+
+  /* res is the result of the last Term entered, NOT_YET if it got a frame (the top one). */
+  while(!frames.empty()) {
+
+    Frame & f = frames.back();
+
+    unsigned int done = (f.op == O_BOX || f.op == O_DIAMOND) ? stepModal(f,res) : stepBoolean(f,res);
+
+    /* A child got a frame, it is the top one now. */
+    if(done == NOT_YET) { res = NOT_YET; continue; }
+
+    if(cache != NULL) cache->store(f.node->getTermId(),f.world,done);
+
+    frames.pop_back();
+    res = done;
+  }
+
+  return res;
+}
+
+/**
+ * @brief This method will start the check of a Term in a world.
+ *
+ * @param[in] term the Term to check.
+ *
+ * @param[in] w the world in which the Term is checked.
+ *
+ * @return {OK,KO,UNKNOWN} if the result is already known, NOT_YET if a frame was pushed for the Term.
+ */
+unsigned int IterativeChecker::enter(Term* term, unsigned int w) {
+
+  /* A Term without children does not call anything. */
+  if(term->getNbChildren() == 0) return term->checkBranch(kripke,w,context);
+
+  if(context.getCache() != NULL) {
+
+    unsigned int res = context.lookup(term->getTermId(),w,term);
+
+    if(res != NOT_YET) return res;
+  }
+
+  Frame f;
+  f.node = term;
+  f.sub = NULL;
+  f.world = w;
+  f.at = w;
+  f.next = 0;
+  f.op = static_cast<Operation*>(term)->getOperator();
+  f.flags = NO_UNKNOWN | NO_KO;
+
+  if(f.op == O_BOX || f.op == O_DIAMOND) f.sub = static_cast<ModalOperation*>(term)->getCheckedChild(kripke,f.at);
+
+  frames.push_back(f);
+
+  return NOT_YET;
+}
+
+/**
+ * @brief This method will go on with the check of a BooleanOperation, as far as it can without a new frame.
+ *
+ * @param[in,out] f the frame of the BooleanOperation (it can not be used anymore if a frame is pushed).
+ *
+ * @param[in] res the result of the last child entered (NOT_YET if the frame was just pushed).
+ *
+ * @return {OK,KO,UNKNOWN} the result of the BooleanOperation, NOT_YET if a frame was pushed for one of its children.
+ */
+unsigned int IterativeChecker::stepBoolean(Frame & f, unsigned int res) {
+
+  unsigned int nbChildren = f.node->getNbChildren();
+
+  for(;;) {
+
+    /* OK v whatever is OK, KO ^ whatever is KO. */
+    if(res == OK && f.op == O_OR) return OK;
+    if(res == KO && f.op != O_OR) return KO;
+
+    if(res == KO)      f.flags &= ~NO_KO;
+    if(res == UNKNOWN) f.flags &= ~NO_UNKNOWN;
+
+    if(f.next == nbChildren) break;
+
+    res = enter(f.node->getChild(f.next++),f.world);
+
+    /* The frames may have moved, f is not valid anymore. */
+    if(res == NOT_YET) return NOT_YET;
+  }
+
+  /* (KO v KO ... v KO) is KO, (OK ^ OK ... ^ OK) is OK. */
+  if(f.flags & NO_UNKNOWN) return (f.op == O_OR) ? KO : OK;
+
+  /* The same reasons as BooleanOperation::checkBranch. */
+  if(f.op != O_OR)              context.setReason(f.node,UNKNOWN_AND_UNKNOWN,f.world);
+
+  else if(!(f.flags & NO_KO))   context.setReason(f.node,UNKNOWN_OR_KO,f.world);
+
+  else                          context.setReason(f.node,UNKNOWN_OR_UNKNOWN,f.world);
+
+  return UNKNOWN;
+}
+
+/**
+ * @brief This method will go on with the check of a ModalOperation, as far as it can without a new frame.
+ *
+ * @param[in,out] f the frame of the ModalOperation (it can not be used anymore if a frame is pushed).
+ *
+ * @param[in] res the result of the sub-formula in the last successor entered (NOT_YET if the frame was just pushed).
+ *
+ * @return {OK,KO,UNKNOWN} the result of the ModalOperation, NOT_YET if a frame was pushed for the sub-formula.
+ */
+unsigned int IterativeChecker::stepModal(Frame & f, unsigned int res) {
+
+  WorldSpan worldConnected = kripke.getConnectedWorlds(f.at);
+  unsigned int size = worldConnected.size();
+
+  for(;;) {
+
+    /* One OK successor is enough for a diamond, the first successor which is not OK gives the result of a box. */
+    if(res == OK && f.op == O_DIAMOND) return OK;
+    if(res != OK && res != NOT_YET && f.op == O_BOX) return res;
+
+    if(f.next == size) break;
+
+    res = enter(f.sub,worldConnected[f.next++]);
+
+    /* The frames may have moved, f is not valid anymore. */
+    if(res == NOT_YET) return NOT_YET;
+  }
+
+  if(f.op == O_BOX) return OK;
+
+  /* The same reason as ModalOperation::checkBranch. */
+  context.setReason(f.node,NO_EDGE_IS_GIVING_WHAT_WE_SEARCH,f.at);
+
+  return UNKNOWN;
+}
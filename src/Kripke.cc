@@ -30,169 +30,607 @@
  * @date 15/03/2016
  */
 
-#include "../include/Kripke.h"
+#include "../include/KripkeReader.h"
 
-/** @brief We define the MAX width of a line in the Kripke-CNF file. It should normally never cross this limit. */
-#define LIMIT_LINE 100000
+#include <unistd.h>
+#include <sys/mman.h>
 
-/** 
- * @brief This method will assigned the atom 'value' in the world 'world'.
- * 
- * @param[in] value the atom that we want to assign (value < 0) if we want to atom negatively.
+/** @brief The distance of a world which is not reached from w0 (by a path of length at most the depth). */
+#define NOT_REACHED (~0u)
+
+/** @brief The version of the binary format written by Kripke::writeBinary. */
+#define BINARY_VERSION 1
+
+/** @brief The size of the header of the binary format (magic, version, nbVariables, nbWorlds, nbEdges, rowWords). */
+#define BINARY_HEADER 32
+
+const char Kripke::BINARY_MAGIC[5] = "MDKB";
+
+/**
+ * @brief This method is the destructor, it will release the binary model (if any).
+ */
+Kripke::~Kripke() {
+
+  if(binaryData == NULL) return;
+
+  if(binaryMapped) munmap((void*) binaryData, binarySize);
+  else             free((void*) binaryData);
+}
+
+/**
+ * @brief This method will make every row of the valuation matrix large enough for the atom 'value'.
  *
- * @param[in] world the world in which the atom is assigned.
+ * @param[in] value the atom that does not fit in a row.
  */
-void Kripke::assignValue(int value, unsigned int world) {
+void Kripke::growRows(unsigned int value) {
+
+  size_t newRowWords = (value + VARIABLES_PER_WORD - 1) / VARIABLES_PER_WORD;
+  vector<uint64_t> larger((size_t) num_worlds * newRowWords, 0);
+
+  for(unsigned int i = 0; i < num_worlds; i++) {
+    std::copy(valuations.begin() + i * rowWords, valuations.begin() + (i+1) * rowWords, larger.begin() + i * newRowWords);
+  }
+
+  valuations.swap(larger);
+  valuationData = valuations.data();
+  rowWords = newRowWords;
+}
+
+/**
+ * @brief This method will set the size of the model, before any assignation or edge is added.
+ *
+ * @param[in] nbVariables the number of propositional variables.
+ *
+ * @param[in] nbWorlds the number of worlds.
+ *
+ * @param[in] nbEdges the number of edges (only to reserve the memory).
+ *
+ * @param[in] withValuations false if the valuation matrix is only allocated by Kripke::pruneUnreachable (the rows are parsed after it).
+ */
+void Kripke::initialize(unsigned int nbVariables, unsigned int nbWorlds, size_t nbEdges, bool withValuations) {
+
+  num_variables  = nbVariables;
+  num_worlds     = nbWorlds;
+  declaredWorlds = nbWorlds;
+
+  /* The assignations are a matrix [nbWorlds][nbVariables] of 2 bits per cell. */
+  rowWords = (num_variables + VARIABLES_PER_WORD - 1) / VARIABLES_PER_WORD;
+
+  if(withValuations) {
+    valuations.assign((size_t) num_worlds * rowWords, 0);
+    valuationData = valuations.data();
+  }
+
+  /* The edges are stored at the end, the number of edges is given in the header. */
+  pendingEdges.reserve(2 * nbEdges);
+}
+
+/**
+ * @brief This method will parse the Kripke-CNF solution on the STDIN.
+ *
+ * @param[in] depth the modal depth of the formula, the worlds further from w0 are not kept (NO_PRUNING to keep everything).
+ */
+void Kripke::parseSolutionFile(unsigned int depth) {
+
+  KripkeReader reader(*this);
+
+  reader.setPruneDepth(depth);
+
+  reader.readStream(STDIN_FILENO);
+}
+
+/**
+ * @brief This method will parse the Kripke-CNF solution in the file 'path'.
+ *
+ * @param[in] path the path of the solution (a regular file is mapped in memory, anything else is read as a stream).
+ *
+ * @param[in] nbThreads how many threads can parse a mapped file at the same time.
+ *
+ * @param[in] depth the modal depth of the formula, the worlds further from w0 are not kept (NO_PRUNING to keep everything).
+ */
+void Kripke::parseSolutionFile(const char* path, unsigned int nbThreads, unsigned int depth) {
+
+  KripkeReader reader(*this);
+
+  reader.setNbThreads(nbThreads);
+  reader.setPruneDepth(depth);
+
+  reader.readFile(path);
+}
+
+/**
+ * @brief This method will store all the pending edges in the CSR arrays (edgeOffsets and edgeTargets).
+ *
+ * It is a counting sort in 2 passes: first we count the edges of each world, then we put each target at its place.
+ * The order of the edges of a world is kept.
+ */
+void Kripke::buildEdges() {
+
+  size_t nbEdges = pendingEdges.size() / 2;
 
-  unsigned int abs_value = abs(value);
+  edgeOffsets.assign(num_worlds + 1, 0);
+  edgeTargets.resize(nbEdges + 1);
 
-  if(abs_value >= assignations[world].size()) {
+  /* First pass: edgeOffsets[w+1] is the number of edges from w. */
+  for(size_t i = 0; i < nbEdges; i++) {
 
-    for(unsigned int i =0 ; i < num_worlds; i++) {
-        assignations[i].resize(abs_value);
+    if(pendingEdges[2*i] >= num_worlds || pendingEdges[2*i+1] >= num_worlds) {
+      printf("ERROR: the edge w%u -> w%u is not between 2 worlds of the model.\n",pendingEdges[2*i],pendingEdges[2*i+1]);
+      exit(0);
     }
+
+    edgeOffsets[pendingEdges[2*i] + 1]++;
   }
 
-  /* If we want to assign p'value' positevely, we just put an 1 in [world][value-1] */
-  if(value > 0)
-	 assignations[world][value-1] = 1;
+  for(unsigned int w = 0; w < num_worlds; w++) edgeOffsets[w+1] += edgeOffsets[w];
+
+  /* Second pass: each target goes at the next free place of its starting world. */
+  vector<uint64_t> next(edgeOffsets.begin(), edgeOffsets.end() - 1);
 
-  /* If we want to assign p'value' negatively, we just put an -1 in [world][value-1] */
-  else if(value < 0)
-    assignations[world][abs_value-1] = -1;
+  for(size_t i = 0; i < nbEdges; i++) edgeTargets[next[pendingEdges[2*i]]++] = pendingEdges[2*i+1];
 
+  vector<unsigned int>().swap(pendingEdges);
+
+  offsetData = edgeOffsets.data();
+  targetData = edgeTargets.data();
 }
 
 /**
- * @brief This method will parse the Kripke-CNF solution on the STDIN.
+ * @brief This method will keep only the worlds at distance at most 'depth' from w0, and the edges leaving the worlds at distance less than 'depth'.
+ *
+ * @param[in] depth the modal depth of the formula.
  */
-void Kripke::parseSolutionFile() {
+void Kripke::pruneUnreachable(unsigned int depth) {
 
-  char str[LIMIT_LINE];
-  FILE * file;
-  int firstLine = 0;
-  int descriptionSolution[4];
-  int i = 0;
-  int nbLines = 0;
-  char* token = NULL;
-  int w_begin = 0;
-  int w_end = 0;;
+  if(num_worlds == 0) return;
 
-  bool satFound = false;
+  /* Breadth-first search from w0, which stops at the distance 'depth'. */
+  vector<unsigned int> distance(num_worlds, NOT_REACHED);
+  vector<unsigned int> queue(1, 0);
+  unsigned int nbKept = 1;
 
-  file = stdin;
+  distance[0] = 0;
 
-  if (file) {
+  for(size_t i = 0; i < queue.size(); i++) {
 
-    while(fgets(str, LIMIT_LINE-1, file) != NULL) {
-      
-      if(str[0] == 'c') {
-        continue;
-      }
+    unsigned int w = queue[i];
 
-      if(strstr(str,"s UNSATISFIABLE")) {
-        printf("ERROR: UNSATISFIABLE formulae are not checkable yet.\n\n");
-        exit(0);
-      }
+    if(distance[w] >= depth) continue;
 
+    for(const unsigned int* t = targetData + offsetData[w]; t < targetData + offsetData[w+1]; t++) {
 
-      if(!satFound && strstr(str,"s SATISFIABLE")) {
+      if(distance[*t] != NOT_REACHED) continue;
 
-        satFound = true;
-      }
+      distance[*t] = distance[w] + 1;
+      queue.push_back(*t);
+      nbKept++;
+    }
+  }
 
-      if(str[0] == 'v') {
-        
-        if(firstLine == 0) {
+  vector<unsigned int>().swap(queue);
 
-          token = strtok(str+1, " ");
-          while( token != NULL ) {
+  bool withValuations = valuationData != NULL;
 
-              descriptionSolution[i] = atoi(token);
-              i++;
-              
-              /* Get next token: */
-              token = strtok( NULL, " ");
-          }
+  if(nbKept == num_worlds && withValuations) return;
 
-          num_variables = descriptionSolution[0];
-          num_worlds    = descriptionSolution[1];
+  /* The worlds kept are renumbered in their original order, so w0 stays w0. */
+  vector<unsigned int> newIds(num_worlds, NOT_REACHED);
+  vector<unsigned int> ids;
+  ids.reserve(nbKept);
 
-          if(num_variables == 0) {
+  for(unsigned int w = 0; w < num_worlds; w++) {
+    if(distance[w] != NOT_REACHED) { newIds[w] = ids.size(); ids.push_back(getOriginalId(w)); }
+  }
 
-              printf("UNKNOWN: No model was provided.\n\n");
-              exit(0);
-          }
+  /* The rows of the worlds kept (empty ones if the rows are parsed after). */
+  vector<uint64_t> keptValuations((size_t) nbKept * rowWords, 0);
 
-            /* edges is a matrix [nbWorlds][nbWorlds] so we need to initialize it as an array of arrays */
-            edges = (vector<unsigned>**)malloc(sizeof(vector<unsigned int>*)*num_worlds);
-            assignations.resize(num_worlds);
+  if(withValuations) {
+    for(unsigned int w = 0; w < num_worlds; w++) {
+      if(newIds[w] != NOT_REACHED) std::copy(getRow(w), getRow(w) + rowWords, keptValuations.begin() + (size_t) newIds[w] * rowWords);
+    }
+  }
 
-            for(unsigned int i =0 ; i < num_worlds; i++) {
-                edges[i] = new vector<unsigned>();
-                assignations[i].resize(num_variables);
-            }
+  /* The edges leaving a world at the distance 'depth' can not be followed by the formula. */
+  vector<uint64_t> keptOffsets(nbKept + 1, 0);
+  vector<unsigned int> keptTargets;
 
-        } else {
+  for(unsigned int w = 0; w < num_worlds; w++) {
 
-          if(nbLines < descriptionSolution[1]) {
-            
-            token = strtok(str+1, " ");
-            i = 0;
-            while( token != NULL ) {
+    if(newIds[w] == NOT_REACHED) continue;
 
-              if(atoi(token) != 0) {
+    if(distance[w] < depth) {
+      for(const unsigned int* t = targetData + offsetData[w]; t < targetData + offsetData[w+1]; t++) keptTargets.push_back(newIds[*t]);
+    }
 
-                int value = atoi(token);
+    keptOffsets[newIds[w] + 1] = keptTargets.size();
+  }
 
-                assignValue(value,nbLines);
+  replaceModel(keptValuations, keptOffsets, keptTargets, ids);
+}
 
-                i++;
-              }
-              
-              /* Get next token: */
-              token = strtok( NULL, " ");
-            }
+/**
+ * \struct SignatureTable
+ *
+ * @brief A hash table which gives the same number to the worlds having the same signature (a sequence of words).
+ *
+ * The signatures are stored one after the other, and the table only keeps their number (open addressing).
+ */
+struct SignatureTable {
+
+  /** @brief The distinct signatures, one after the other. */
+  vector<uint64_t> words;
+
+  /** @brief Where each distinct signature starts in words (and where the next one would start). */
+  vector<size_t> starts;
+
+  /** @brief The hash table: the number of a signature + 1, or 0 for an empty slot. */
+  vector<unsigned int> slots;
+
+  /**
+   * @brief To construct a table, we need how many distinct signatures there can be at most.
+   *
+   * @param[in] nbMax the maximum number of distinct signatures.
+   */
+  SignatureTable(size_t nbMax) : starts(1, 0) {
+    size_t size = 16;
+    while(size < 2 * nbMax) size <<= 1;
+    slots.assign(size, 0);
+  }
 
-          } else {
+  /**
+   * @brief This method will return the number of a signature, a new one if it was never seen.
+   *
+   * @param[in] signature the words of the signature.
+   *
+   * @param[in] length the number of words.
+   *
+   * @return the number of the signature (the distinct signatures are numbered 0, 1, ... in the order they are seen).
+   */
+  unsigned int find(const uint64_t* signature, size_t length) {
+
+    uint64_t h = length;
+    for(size_t i = 0; i < length; i++) h = (h ^ signature[i]) * 0x9E3779B97F4A7C15ULL;
+
+    for(size_t slot = (h >> 20) & (slots.size() - 1); ; slot = (slot + 1) & (slots.size() - 1)) {
+
+      if(slots[slot] == 0) {
+        words.insert(words.end(), signature, signature + length);
+        starts.push_back(words.size());
+        slots[slot] = starts.size() - 1;
+        return slots[slot] - 1;
+      }
 
-            token = strtok(str+1, " ");
-            i = 0;
+      unsigned int b = slots[slot] - 1;
 
-            while( token != NULL ) {
+      if(starts[b+1] - starts[b] == length && std::equal(signature, signature + length, words.begin() + starts[b])) return b;
+    }
+  }
+};
 
-              if(i == 1) {
-                w_begin = atoi(token+1); 
-              }
+/**
+ * @brief This method will replace every world by the class of the worlds which are bisimilar to it.
+ *
+ * @param[in] depth the modal depth of the formula (NO_PRUNING for a model which is right for every formula).
+ */
+void Kripke::reduceBisimilar(unsigned int depth) {
 
-              if(i == 2) {
-                w_end = atoi(token+1); 
-              }
+  if(num_worlds == 0) return;
 
-              i++;
+  /* First the worlds are grouped by valuation. */
+  vector<unsigned int> block(num_worlds);
+  unsigned int nbBlocks;
 
-              /* Get next token: */
-              token = strtok( NULL, " ");
-            }
+  {
+    SignatureTable table(num_worlds);
+    for(unsigned int w = 0; w < num_worlds; w++) block[w] = table.find(getRow(w), rowWords);
+    nbBlocks = table.starts.size() - 1;
+  }
+
+  /* The signature of a world: its group, then the groups of its successors, in order, each one only the first time. */
+  vector<uint64_t> signature;
+  vector<unsigned int> seen(num_worlds, 0);
+
+  for(unsigned int round = 0; round < depth; round++) {
+
+    SignatureTable table(num_worlds);
+    vector<unsigned int> refined(num_worlds);
 
-            addEdge(w_begin,w_end);
-          }
+    for(unsigned int w = 0; w < num_worlds; w++) {
 
-          nbLines++;
-        }
+      signature.assign(1, block[w]);
 
-        firstLine = 1;
+      for(const unsigned int* t = targetData + offsetData[w]; t < targetData + offsetData[w+1]; t++) {
+        if(seen[block[*t]] != w + 1) { seen[block[*t]] = w + 1; signature.push_back(block[*t]); }
       }
 
+      refined[w] = table.find(&signature[0], signature.size());
     }
 
-  } else {
-    fprintf(stderr,"Problem with the solution file !\n");
-    exit(-2);
+    std::fill(seen.begin(), seen.end(), 0);
+
+    block.swap(refined);
+
+    /* Each group is split or kept, so if there are as many groups, nothing changed. */
+    if(table.starts.size() - 1 == nbBlocks) break;
+
+    nbBlocks = table.starts.size() - 1;
+  }
+
+  if(nbBlocks == num_worlds) return;
+
+  /* Each group becomes a world, the first world of the group gives its valuation and its edges (w0 stays w0). */
+  vector<unsigned int> representative(nbBlocks, NOT_REACHED);
+  vector<unsigned int> ids(nbBlocks);
+
+  for(unsigned int w = 0; w < num_worlds; w++) {
+    if(representative[block[w]] == NOT_REACHED) { representative[block[w]] = w; ids[block[w]] = getOriginalId(w); }
+  }
+
+  vector<uint64_t> reducedValuations((size_t) nbBlocks * rowWords);
+  vector<uint64_t> reducedOffsets(nbBlocks + 1, 0);
+  vector<unsigned int> reducedTargets;
+
+  for(unsigned int b = 0; b < nbBlocks; b++) {
+
+    unsigned int w = representative[b];
+
+    std::copy(getRow(w), getRow(w) + rowWords, reducedValuations.begin() + (size_t) b * rowWords);
+
+    for(const unsigned int* t = targetData + offsetData[w]; t < targetData + offsetData[w+1]; t++) {
+      if(seen[block[*t]] != b + 1) { seen[block[*t]] = b + 1; reducedTargets.push_back(block[*t]); }
+    }
+
+    reducedOffsets[b+1] = reducedTargets.size();
   }
 
-  if(!satFound) {
-    printf("ERROR: solution not in Kripke-CNF.\n");
+  reducedTargets.push_back(0);
+
+  replaceModel(reducedValuations, reducedOffsets, reducedTargets, ids);
+}
+
+/**
+ * @brief This method will use the given arrays as the model (they are swapped with the ones of the model).
+ *
+ * @param[in,out] rows the valuation matrix.
+ *
+ * @param[in,out] offsets the offsets of the edges.
+ *
+ * @param[in,out] targets the targets of the edges.
+ *
+ * @param[in,out] ids the id in the solution of each world.
+ */
+void Kripke::replaceModel(vector<uint64_t> & rows, vector<uint64_t> & offsets, vector<unsigned int> & targets, vector<unsigned int> & ids) {
+
+  valuations.swap(rows);
+  edgeOffsets.swap(offsets);
+  edgeTargets.swap(targets);
+  originalIds.swap(ids);
+
+  num_worlds    = originalIds.size();
+  valuationData = valuations.data();
+  offsetData    = edgeOffsets.data();
+  targetData    = edgeTargets.data();
+
+  /* The transposed bitsets and the reverse edges are built again for the new worlds. */
+  vector<uint64_t>().swap(worldsWhereTrue);
+  vector<uint64_t>().swap(worldsWhereFalse);
+  vector<uint64_t>().swap(predecessorOffsets);
+  vector<unsigned int>().swap(predecessorTargets);
+  vector<uint64_t>().swap(everySuccessor);
+  vector<uint64_t>().swap(someSuccessor);
+
+  /* Nothing points in the binary model anymore. */
+  if(binaryData != NULL) {
+
+    if(binaryMapped) munmap((void*) binaryData, binarySize);
+    else             free((void*) binaryData);
+
+    binaryData = NULL;
+  }
+}
+
+/**
+ * @brief This method will use a binary model (see Kripke::writeBinary) as it is in memory, without any copy.
+ *
+ * @param[in] data the binary model (the Kripke model takes its ownership).
+ *
+ * @param[in] size the number of bytes of data.
+ *
+ * @param[in] mapped true if data is a mapping of the file (released by munmap), false if it was allocated by malloc.
+ */
+void Kripke::loadBinary(const char* data, size_t size, bool mapped) {
+
+  binaryData = data;
+  binarySize = size;
+  binaryMapped = mapped;
+
+  uint32_t header[4] = {0, 0, 0, 0};
+  uint64_t nbEdges = 0, nbRowWords = 0;
+
+  if(size >= BINARY_HEADER) {
+    memcpy(header, data, 16);
+    memcpy(&nbEdges, data + 16, 8);
+    memcpy(&nbRowWords, data + 24, 8);
+  }
+
+  if(size >= BINARY_HEADER && header[1] != BINARY_VERSION) {
+    printf("ERROR: binary model of version %u (expected version %d).\n", header[1], BINARY_VERSION);
     exit(0);
   }
-}
\ No newline at end of file
+
+  num_variables  = header[2];
+  num_worlds     = header[3];
+  declaredWorlds = header[3];
+  rowWords       = nbRowWords;
+
+  /* The counts of the header can not be larger than the file (so the size computed below does not overflow). */
+  bool fits = size >= BINARY_HEADER && nbEdges <= size / 4 && (rowWords == 0 || num_worlds <= size / 8 / rowWords);
+
+  uint64_t valuationWords = fits ? (uint64_t) num_worlds * rowWords : 0;
+  uint64_t expectedSize = BINARY_HEADER + 8 * (valuationWords + num_worlds + 1) + 4 * nbEdges;
+
+  valuationData = (const uint64_t*) (data + BINARY_HEADER);
+  offsetData    = valuationData + valuationWords;
+  targetData    = (const unsigned int*) (offsetData + num_worlds + 1);
+
+  /* The engines read the rows, the offsets and the targets without any check, so all of them are checked once here. */
+  bool valid = fits && size >= expectedSize
+            && rowWords >= (num_variables + VARIABLES_PER_WORD - 1) / VARIABLES_PER_WORD
+            && offsetData[0] == 0 && offsetData[num_worlds] == nbEdges;
+
+  for(unsigned int w = 0; valid && w < num_worlds; w++) valid = offsetData[w] <= offsetData[w+1];
+
+  for(uint64_t e = 0; valid && e < nbEdges; e++) valid = targetData[e] < num_worlds;
+
+  if(!valid) {
+    printf("ERROR: the binary model is truncated or corrupted.\n");
+    exit(0);
+  }
+}
+
+/**
+ * @brief This method will write the model in the binary format, which can then be given instead of the Kripke-CNF solution.
+ *
+ * @param[in] path the path of the binary model.
+ */
+void Kripke::writeBinary(const char* path) {
+
+  FILE* f = fopen(path,"wb");
+
+  if(f == NULL) {
+    fprintf(stderr,"Problem with opening the binary model %s\n",path);
+    exit(-2);
+  }
+
+  /* Without any world, no CSR array was built: the only offset is 0. */
+  const uint64_t noEdge = 0;
+  const uint64_t* offsets = (num_worlds == 0) ? &noEdge : offsetData;
+
+  uint32_t header[4] = { 0, BINARY_VERSION, num_variables, num_worlds };
+  uint64_t nbEdges = offsets[num_worlds], nbRowWords = rowWords;
+
+  memcpy(header, BINARY_MAGIC, 4);
+
+  bool written = fwrite(header, 4, 4, f) == 4
+              && fwrite(&nbEdges, 8, 1, f) == 1
+              && fwrite(&nbRowWords, 8, 1, f) == 1
+              && fwrite(valuationData, 8, (size_t) num_worlds * rowWords, f) == (size_t) num_worlds * rowWords
+              && fwrite(offsets, 8, num_worlds + 1, f) == (size_t) num_worlds + 1
+              && fwrite(targetData, 4, nbEdges, f) == nbEdges;
+
+  if(fclose(f) != 0 || !written) {
+    fprintf(stderr,"Problem with writing the binary model %s\n",path);
+    exit(-2);
+  }
+}
+
+/**
+ * @brief This method will build, once, the bitsets of the worlds where each variable is true and false.
+ */
+void Kripke::transposeAssignations() {
+
+  if(!worldsWhereTrue.empty()) return;
+
+  nbTransposedVariables = rowWords * VARIABLES_PER_WORD;
+  wordsPerVariable = (num_worlds + 63) / 64;
+
+  /* The bitset 0 stays empty, it is the one of every atom which is not in the model. */
+  worldsWhereTrue.assign((nbTransposedVariables + 1) * wordsPerVariable + 1, 0);
+  worldsWhereFalse.assign((nbTransposedVariables + 1) * wordsPerVariable + 1, 0);
+
+  for(unsigned int w = 0; w < num_worlds; w++) {
+
+    uint64_t bit = (uint64_t) 1 << (w & 63);
+    size_t word = w >> 6;
+
+    const uint64_t* row = getRow(w);
+
+    for(unsigned int v = 0; v < nbTransposedVariables; v++) {
+
+      unsigned int cell = (row[v / VARIABLES_PER_WORD] >> ((v % VARIABLES_PER_WORD) << 1)) & 3;
+
+      if(cell == 1)      worldsWhereTrue[(v+1) * wordsPerVariable + word] |= bit;
+
+      else if(cell == 2) worldsWhereFalse[(v+1) * wordsPerVariable + word] |= bit;
+    }
+  }
+}
+
+/**
+ * @brief This method will build, for every world, the AND and the OR of the rows of its successors.
+ *
+ * A bit of the AND (OR) is set if the atom is assigned this way in every (one) successor.
+ */
+void Kripke::aggregateSuccessors() {
+
+  everySuccessor.assign((size_t) num_worlds * rowWords, ~(uint64_t) 0);
+  someSuccessor.assign((size_t) num_worlds * rowWords, 0);
+
+  for(unsigned int w = 0; w < num_worlds; w++) {
+
+    uint64_t* every = &everySuccessor[(size_t) w * rowWords];
+    uint64_t* some = &someSuccessor[(size_t) w * rowWords];
+
+    for(const unsigned int* t = targetData + offsetData[w]; t < targetData + offsetData[w+1]; t++) {
+
+      const uint64_t* row = getRow(*t);
+
+      for(size_t i = 0; i < rowWords; i++) { every[i] &= row[i]; some[i] |= row[i]; }
+    }
+  }
+}
+
+/**
+ * @brief This method will count, for every atom, in how many worlds it is assigned positively and negatively.
+ *
+ * @param[out] nbTrue nbTrue[v] is the number of worlds where p'v' is assigned positively (nbTrue[0] is not used).
+ *
+ * @param[out] nbFalse nbFalse[v] is the number of worlds where p'v' is assigned negatively.
+ */
+void Kripke::countAssignations(vector<unsigned int> & nbTrue, vector<unsigned int> & nbFalse) {
+
+  nbTrue.assign(rowWords * VARIABLES_PER_WORD + 1, 0);
+  nbFalse.assign(rowWords * VARIABLES_PER_WORD + 1, 0);
+
+  for(unsigned int w = 0; w < num_worlds; w++) {
+
+    const uint64_t* row = getRow(w);
+
+    /* Only the assigned cells are visited: bit 2(v-1) is p'v', bit 2(v-1)+1 is ~p'v'. */
+    for(size_t i = 0; i < rowWords; i++) {
+
+      for(uint64_t bits = row[i]; bits != 0; bits &= bits - 1) {
+
+        unsigned int bit = __builtin_ctzll(bits);
+        unsigned int value = i * VARIABLES_PER_WORD + (bit >> 1) + 1;
+
+        if(bit & 1) nbFalse[value]++;
+        else        nbTrue[value]++;
+      }
+    }
+  }
+}
+
+/**
+ * @brief This method will build the reverse CSR edges, by a counting sort of the edges on their arrival world.
+ */
+void Kripke::reverseEdges() {
+
+  size_t nbEdges = getNbEdges();
+
+  predecessorOffsets.assign(num_worlds + 1, 0);
+  predecessorTargets.resize(nbEdges + 1);
+
+  /* First pass: predecessorOffsets[w+1] is the number of edges to w. */
+  for(size_t i = 0; i < nbEdges; i++) predecessorOffsets[targetData[i] + 1]++;
+
+  for(unsigned int w = 0; w < num_worlds; w++) predecessorOffsets[w+1] += predecessorOffsets[w];
+
+  /* Second pass: the starting worlds are read in increasing order, so each list is sorted. */
+  vector<uint64_t> next(predecessorOffsets.begin(), predecessorOffsets.end() - 1);
+
+  for(unsigned int w = 0; w < num_worlds; w++) {
+    for(uint64_t i = offsetData[w]; i < offsetData[w+1]; i++) predecessorTargets[next[targetData[i]]++] = w;
+  }
+}
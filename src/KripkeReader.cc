@@ -0,0 +1,804 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+/**
+ * \file KripkeReader.cc
+ * @brief Implementation of KripkeReader::methods which are not in the KripkeReader.h
+ *
+ * @version 1.0
+ */
+
+#include "../include/KripkeReader.h"
+#include "../include/Decompressor.h"
+
+#include <cstring>
+#include <thread>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define KRIPKE_READER_X86 1
+#endif
+
+/** @brief A pipe is read by blocks of 16 MB (a block grows if one line is larger). */
+#define STREAM_BLOCK (16 << 20)
+
+/** @brief A chunk parsed by a thread is at least 1 MB (a smaller file is parsed by one thread). */
+#define MIN_CHUNK (1 << 20)
+
+/** @brief The scanner classifies 64 bytes at a time (one bit per byte in a 64-bit mask). */
+#define SCAN_BLOCK 64
+
+/**
+ * @brief This function will tell if c separates two tokens of a line.
+ */
+static inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+/**
+ * @brief This function will skip the blanks in front of p.
+ *
+ * @param[in,out] p the current position, after the blanks at the end.
+ *
+ * @param[in] end the end of the line.
+ */
+static inline void skipBlanks(const char* & p, const char* end) { while(p < end && isBlank(*p)) p++; }
+
+/**
+ * @brief This function will decode the integer at the beginning of a token, like atoi would do.
+ *
+ * When 8 bytes can be read, the digits are found and decoded 8 at a time in a 64-bit word (SWAR).
+ *
+ * @param[in] p the beginning of the token.
+ *
+ * @param[in] limit after the last byte that can be read (it can be after the end of the line).
+ *
+ * @return the integer (0 if the token does not start with an integer).
+ */
+static inline int decodeInt(const char* p, const char* limit) {
+
+  uint32_t value = 0;
+  const char* start = p;
+
+  if(limit - p >= 9) {
+
+    /* The sign is skipped without a branch (it is '-' for half of the literals). */
+    uint32_t negative = (*p == '-');
+    p += negative | (*p == '+');
+
+    uint64_t word;
+    memcpy(&word, p, 8);
+
+    /* The digits become 0..9, and a byte is not a digit if it is 10 or more (the first one is the lowest byte). */
+    uint64_t digits = word ^ 0x3030303030303030ULL;
+    uint64_t notDigits = ((digits + 0x7676767676767676ULL) | digits) & 0x8080808080808080ULL;
+
+    if(notDigits != 0) {
+
+      unsigned int nbDigits = __builtin_ctzll(notDigits) >> 3;
+
+      if(nbDigits == 0) return 0;
+
+      /* The digits go to the highest bytes (with 0s before them), then they are combined 2 by 2, 4 by 4 and 8 by 8. */
+      digits <<= 8 * (8 - nbDigits);
+      digits = ((digits & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+      digits = ((digits & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+      value = (uint32_t) (((digits & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32);
+
+      return (int) ((value ^ -negative) + negative);
+    }
+
+    /* More than 8 digits. */
+    p = start;
+  }
+
+  bool negative = false;
+
+  if(p < limit && (*p == '-' || *p == '+')) negative = (*p++ == '-');
+
+  while(p < limit && (unsigned) (*p - '0') < 10) value = value * 10 + (*p++ - '0');
+
+  return negative ? -(int) value : (int) value;
+}
+
+/**
+ * @brief The separators (blanks and '\n') of 64 bytes, one byte at a time.
+ */
+static uint64_t scanScalar(const char* p) {
+
+  uint64_t separators = 0;
+
+  for(unsigned int i = 0; i < SCAN_BLOCK; i++) separators |= (uint64_t) (isBlank(p[i]) || p[i] == '\n') << i;
+
+  return separators;
+}
+
+#ifdef KRIPKE_READER_X86
+
+/**
+ * @brief The separators (blanks and '\n') of 64 bytes, 32 bytes at a time.
+ */
+__attribute__((target("avx2")))
+static uint64_t scanAVX2(const char* p) {
+
+  uint64_t separators = 0;
+
+  for(unsigned int i = 0; i < SCAN_BLOCK; i += 32) {
+
+    __m256i c = _mm256_loadu_si256((const __m256i*) (p + i));
+
+    __m256i blanks = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8(' ')),
+                                                     _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\t'))),
+                                     _mm256_or_si256(_mm256_cmpeq_epi8(c, _mm256_set1_epi8('\r')),
+                                                     _mm256_cmpeq_epi8(c, _mm256_set1_epi8('\n'))));
+
+    separators |= (uint64_t) (uint32_t) _mm256_movemask_epi8(blanks) << i;
+  }
+
+  return separators;
+}
+
+/**
+ * @brief The separators (blanks and '\n') of 64 bytes, all at once.
+ */
+__attribute__((target("avx512bw")))
+static uint64_t scanAVX512(const char* p) {
+
+  __m512i c = _mm512_loadu_si512((const void*) p);
+
+  return _mm512_cmpeq_epi8_mask(c, _mm512_set1_epi8(' '))
+       | _mm512_cmpeq_epi8_mask(c, _mm512_set1_epi8('\t'))
+       | _mm512_cmpeq_epi8_mask(c, _mm512_set1_epi8('\r'))
+       | _mm512_cmpeq_epi8_mask(c, _mm512_set1_epi8('\n'));
+}
+
+#endif
+
+/**
+ * @brief This function will choose the best scanner for the current CPU.
+ *
+ * @param[out] name the name of the chosen scanner.
+ *
+ * @return the best scanner for the current CPU.
+ */
+static KripkeReader::scanner_t chooseScanner(const char* & name) {
+
+#ifdef KRIPKE_READER_X86
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("avx512bw")) { name = "avx512"; return scanAVX512; }
+
+  if(__builtin_cpu_supports("avx2"))     { name = "avx2";   return scanAVX2; }
+#endif
+
+  name = "scalar";
+  return scanScalar;
+}
+
+const char* KripkeReader::scannerName = "scalar";
+
+KripkeReader::scanner_t KripkeReader::scanBlock = chooseScanner(KripkeReader::scannerName);
+
+/**
+ * @brief This function will visit, 64 bytes at a time, the beginning of each token of a line.
+ *
+ * A token starts on a byte which is not a separator, after a separator (or at the beginning of [begin,end[).
+ *
+ * @param[in] begin the first character after the type of the line.
+ *
+ * @param[in] end after the last character of the line.
+ *
+ * @param[in] limit after the last byte that can be read (a block can be read after the end of the line).
+ *
+ * @param[in] onToken called with the beginning of each token, in order.
+ */
+template<typename OnToken>
+static inline void forEachToken(const char* begin, const char* end, const char* limit, OnToken onToken) {
+
+  uint64_t previousInToken = 0;
+
+  for(const char* p = begin; p < end; p += SCAN_BLOCK) {
+
+    uint64_t separators;
+
+    if(limit - p >= SCAN_BLOCK) separators = KripkeReader::scanBlock(p);
+
+    else {
+
+      /* At the end of the data, the block is completed with blanks. */
+      char last[SCAN_BLOCK];
+      memset(last, ' ', SCAN_BLOCK);
+      memcpy(last, p, limit - p);
+
+      separators = KripkeReader::scanBlock(last);
+    }
+
+    /* The bytes after the end of the line are separators. */
+    if(end - p < SCAN_BLOCK) separators |= ~(uint64_t) 0 << (end - p);
+
+    uint64_t inToken = ~separators;
+    uint64_t starts = inToken & ~((inToken << 1) | previousInToken);
+
+    previousInToken = inToken >> 63;
+
+    while(starts != 0) {
+      onToken(p + __builtin_ctzll(starts));
+      starts &= starts - 1;
+    }
+  }
+}
+
+/**
+ * @brief This function will read the status of a 's' line.
+ *
+ * @param[in] p the position after the 's'.
+ *
+ * @param[in] end the end of the line.
+ *
+ * @return 1 for "SATISFIABLE", -1 for "UNSATISFIABLE", 0 otherwise.
+ */
+static inline int readStatus(const char* p, const char* end) {
+
+  skipBlanks(p,end);
+
+  if(end - p >= 13 && !strncmp(p,"UNSATISFIABLE",13)) return -1;
+
+  if(end - p >= 11 && !strncmp(p,"SATISFIABLE",11)) return 1;
+
+  return 0;
+}
+
+/**
+ * @brief This function will decode the worlds of an edge line "v r1 wi wj" (the 2nd and the 3rd tokens, after their 'w').
+ *
+ * @param[in] begin the first character after the 'v'.
+ *
+ * @param[in] end after the last character of the line.
+ *
+ * @param[in] limit after the last byte that can be read.
+ *
+ * @param[out] worlds worlds[1] is wi and worlds[2] is wj (0 if the line does not have this token).
+ */
+static inline void readEdge(const char* begin, const char* end, const char* limit, unsigned int worlds[3]) {
+
+  unsigned int i = 0;
+
+  forEachToken(begin, end, limit, [&](const char* token) { if(i < 3) worlds[i] = (i > 0) ? decodeInt(token + 1, limit) : 0; i++; });
+}
+
+/**
+ * @brief This function will print the error of an UNSATISFIABLE solution and stop.
+ */
+static void unsatisfiable() {
+
+  printf("ERROR: UNSATISFIABLE formulae are not checkable yet.\n\n");
+  exit(0);
+}
+
+/**
+ * @brief To construct a reader, we need the Kripke model in which the solution will be stored.
+ *
+ * @param[in] kripke the Kripke model to fill.
+ */
+KripkeReader::KripkeReader(Kripke & kripke) : kripke(kripke) {
+
+  headerFound = false;
+  satFound = false;
+  nbWorlds = 0;
+  nbLines = 0;
+  nbThreads = 1;
+  pruneDepth = Kripke::NO_PRUNING;
+  deferRows = false;
+  mappedEnd = NULL;
+}
+
+/**
+ * @brief This method will parse the solution in the file 'path' (mapped in memory if it is a regular file).
+ *
+ * @param[in] path the path of the Kripke-CNF solution.
+ */
+void KripkeReader::readFile(const char* path) {
+
+  struct stat st;
+  int fd = open(path, O_RDONLY);
+
+  if(fd < 0 || fstat(fd,&st) < 0) {
+    fprintf(stderr,"Problem with the solution file !\n");
+    exit(-2);
+  }
+
+  /* A pipe (or an empty file) can not be mapped, it is read as a stream. */
+  if(!S_ISREG(st.st_mode) || st.st_size == 0) {
+    readStream(fd);
+    close(fd);
+    return;
+  }
+
+  const char* data = (const char*) mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  if(data == MAP_FAILED) {
+    readStream(fd);
+    close(fd);
+    return;
+  }
+
+  /* A compressed solution is decompressed on another thread, and read as a stream. */
+  if(Decompressor::detect(data, st.st_size) != C_NONE) {
+    munmap((void*) data, st.st_size);
+    readStream(fd);
+    close(fd);
+    return;
+  }
+
+  /* A binary model is used as it is, the mapping now belongs to the Kripke model. */
+  if(Kripke::isBinary(data, st.st_size)) {
+    kripke.loadBinary(data, st.st_size, true);
+    close(fd);
+    prune();
+    return;
+  }
+
+  madvise((void*) data, st.st_size, MADV_SEQUENTIAL);
+
+  parseMapped(data, data + st.st_size);
+
+  /* The valuation lines located in the file are parsed once the model is pruned. */
+  finish();
+
+  munmap((void*) data, st.st_size);
+  close(fd);
+}
+
+/**
+ * @brief This method will parse the solution read, by large blocks, from the file descriptor 'fd'.
+ *
+ * @param[in] fd the file descriptor of the Kripke-CNF solution (0 for STDIN).
+ */
+void KripkeReader::readStream(int fd) {
+
+  vector<char> buffer(STREAM_BLOCK);
+  size_t filled = 0;
+  ssize_t nbRead;
+  bool sniffed = false;
+
+  /* The file descriptor which is read: fd, or the pipe of the decompression thread. */
+  int input = fd;
+
+  while((nbRead = read(input, &buffer[filled], buffer.size() - filled)) != 0) {
+
+    if(nbRead < 0) {
+      fprintf(stderr,"Problem with the solution file !\n");
+      exit(-2);
+    }
+
+    filled += nbRead;
+
+    /* The first bytes tell if the solution is compressed, or a binary model. */
+    if(!sniffed) {
+
+      if(filled < Decompressor::MAGIC_SIZE) continue;
+
+      sniffed = true;
+
+      compression_t format = Decompressor::detect(&buffer[0], filled);
+
+      /* From now on, we read the decompressed data (which may be a binary model too). */
+      if(format != C_NONE) {
+        input = Decompressor::start(fd, format, &buffer[0], filled);
+        filled = 0;
+        sniffed = false;
+        continue;
+      }
+
+      /* A binary model is read entirely, then used as it is. */
+      if(Kripke::isBinary(&buffer[0], filled)) {
+        readBinaryStream(input, &buffer[0], filled);
+        if(input != fd) close(input);
+        return;
+      }
+    }
+
+    const char* rest = parseLines(&buffer[0], &buffer[0] + filled);
+
+    /* The unfinished line goes at the beginning of the buffer, and if it takes the whole buffer, the buffer grows. */
+    size_t restSize = &buffer[0] + filled - rest;
+    memmove(&buffer[0], rest, restSize);
+    filled = restSize;
+
+    if(filled == buffer.size()) buffer.resize(2 * buffer.size());
+  }
+
+  /* The last line may not be finished by '\n' (and a very short solution may not have been parsed yet). */
+  const char* rest = parseLines(&buffer[0], &buffer[0] + filled);
+  if(rest < &buffer[0] + filled) parseLine(rest, &buffer[0] + filled, &buffer[0] + filled);
+
+  if(input != fd) close(input);
+
+  finish();
+}
+
+/**
+ * @brief This method will read the rest of a binary model from the file descriptor 'fd' and give it to the Kripke model.
+ *
+ * @param[in] fd the file descriptor of the binary model.
+ *
+ * @param[in] start the bytes already read.
+ *
+ * @param[in] size the number of bytes already read.
+ */
+void KripkeReader::readBinaryStream(int fd, const char* start, size_t size) {
+
+  size_t capacity = 2 * size;
+  char* data = (char*) malloc(capacity);
+  ssize_t nbRead;
+
+  memcpy(data, start, size);
+
+  while((nbRead = read(fd, data + size, capacity - size)) != 0) {
+
+    if(nbRead < 0) {
+      fprintf(stderr,"Problem with the solution file !\n");
+      exit(-2);
+    }
+
+    size += nbRead;
+
+    if(size == capacity) data = (char*) realloc(data, capacity *= 2);
+  }
+
+  kripke.loadBinary(data, size, false);
+
+  prune();
+}
+
+/**
+ * @brief This method will parse every complete line in [begin,end[.
+ *
+ * @param[in] begin the first character.
+ *
+ * @param[in] end after the last character.
+ *
+ * @return the beginning of the last line if it is not finished by '\n', end otherwise.
+ */
+const char* KripkeReader::parseLines(const char* begin, const char* end) {
+
+  const char* eol;
+
+  while(begin < end && (eol = (const char*) memchr(begin, '\n', end - begin)) != NULL) {
+
+    parseLine(begin, eol, end);
+    begin = eol + 1;
+  }
+
+  return begin;
+}
+
+/**
+ * @brief This method will parse one line [begin,end[ (without the '\n').
+ *
+ * @param[in] begin the first character of the line.
+ *
+ * @param[in] end after the last character of the line.
+ *
+ * @param[in] limit after the last byte that can be read to decode a token.
+ */
+void KripkeReader::parseLine(const char* begin, const char* end, const char* limit) {
+
+  const char* p = begin + 1;
+
+  if(begin == end) return;
+
+  switch(*begin) {
+
+    case 'c': return;
+
+    case 's':
+
+      if(readStatus(p,end) < 0) unsatisfiable();
+
+      if(readStatus(p,end) > 0) satFound = true;
+
+      return;
+
+    case 'v': break;
+
+    default: return;
+  }
+
+  if(!headerFound) {
+
+    /* v nbVariables nbWorlds nbEdges */
+    int descriptionSolution[3] = {0, 0, 0};
+    unsigned int i = 0;
+
+    forEachToken(begin + 1, end, limit, [&](const char* token) { if(i < 3) descriptionSolution[i++] = decodeInt(token,limit); });
+
+    if(descriptionSolution[0] == 0) {
+
+      printf("UNKNOWN: No model was provided.\n\n");
+      exit(0);
+    }
+
+    nbWorlds = descriptionSolution[1];
+    kripke.initialize(descriptionSolution[0], nbWorlds, max(descriptionSolution[2],0), !deferRows);
+
+    if(deferRows) rowLines.assign(nbWorlds, NULL);
+
+    headerFound = true;
+
+  } else if(nbLines < nbWorlds) {
+
+    /* v l1 l2 ... 0 : the literals assigned in the world nbLines. */
+    if(deferRows) rowLines[nbLines] = begin;
+    else          parseValuation(begin, end, limit, nbLines);
+
+    nbLines++;
+
+  } else {
+
+    /* v r1 wi wj */
+    unsigned int worlds[3] = {0, 0, 0};
+    readEdge(begin + 1, end, limit, worlds);
+
+    kripke.addEdge(worlds[1], worlds[2]);
+
+    nbLines++;
+  }
+}
+
+/**
+ * @brief This method will parse the literals of a valuation line [begin,end[ and assign them in the world 'world'.
+ *
+ * @param[in] begin the first character of the line.
+ *
+ * @param[in] end after the last character of the line.
+ *
+ * @param[in] limit after the last byte that can be read to decode a token.
+ *
+ * @param[in] world the world of the line.
+ */
+void KripkeReader::parseValuation(const char* begin, const char* end, const char* limit, unsigned int world) {
+
+  forEachToken(begin + 1, end, limit, [&](const char* token) {
+
+    int value = decodeInt(token,limit);
+
+    if(value != 0) kripke.assignValue(value,world);
+  });
+}
+
+/**
+ * @brief This method will parse a mapped file [begin,end[: the header alone, then the rest in chunks.
+ *
+ * @param[in] begin the first character of the file.
+ *
+ * @param[in] end after the last character of the file.
+ */
+void KripkeReader::parseMapped(const char* begin, const char* end) {
+
+  /* With a pruning depth, we do not know yet which valuation lines are needed. */
+  deferRows = pruneDepth != Kripke::NO_PRUNING;
+  mappedEnd = end;
+
+  /* Until the header, we do not know the size of the model. */
+  while(!headerFound && begin < end) {
+
+    const char* eol = (const char*) memchr(begin, '\n', end - begin);
+    if(eol == NULL) eol = end;
+
+    parseLine(begin, eol, end);
+    begin = (eol < end) ? eol + 1 : end;
+  }
+
+  size_t nbChunks = min((size_t) nbThreads, (size_t) (end - begin) / MIN_CHUNK);
+
+  if(nbChunks <= 1) {
+
+    /* The last line may not be finished by '\n'. */
+    const char* rest = parseLines(begin, end);
+    if(rest < end) parseLine(rest, end, end);
+
+    return;
+  }
+
+  /* Each chunk ends just after a '\n' (or at the end of the file). */
+  vector<Chunk> chunks(nbChunks);
+
+  for(size_t i = 0; i < nbChunks; i++) {
+
+    const char* chunkEnd = (i + 1 == nbChunks) ? end : begin + (end - begin) / (nbChunks - i);
+    const char* eol = (const char*) memchr(chunkEnd - 1, '\n', end - chunkEnd + 1);
+
+    chunks[i].begin = begin;
+    chunks[i].end = begin = (eol == NULL) ? end : eol + 1;
+  }
+
+  vector<std::thread> threads;
+
+  /* First pass : how many 'v' lines in each chunk. */
+  for(size_t i = 1; i < nbChunks; i++) threads.push_back(std::thread(countLines, std::ref(chunks[i])));
+  countLines(chunks[0]);
+  for(size_t i = 0; i < threads.size(); i++) threads[i].join();
+  threads.clear();
+
+  for(size_t i = 0; i < nbChunks; i++) {
+
+    if(chunks[i].unsatisfiable) unsatisfiable();
+    if(chunks[i].satisfiable) satFound = true;
+
+    chunks[i].firstLine = nbLines;
+    nbLines += chunks[i].nbLines;
+  }
+
+  /* Second pass : the valuations go directly in the model, the edges stay in their chunk. */
+  for(size_t i = 1; i < nbChunks; i++) threads.push_back(std::thread(&KripkeReader::parseChunk, this, std::ref(chunks[i])));
+  parseChunk(chunks[0]);
+  for(size_t i = 0; i < threads.size(); i++) threads[i].join();
+  threads.clear();
+
+  /* The literals which did not fit make the rows larger, one by one. */
+  for(size_t i = 0; i < nbChunks; i++) {
+    for(size_t j = 0; j < chunks[i].lateLiterals.size(); j++) kripke.assignValue(chunks[i].lateLiterals[j].first, chunks[i].lateLiterals[j].second);
+  }
+
+  /* The edges of each chunk are copied after the edges of the previous chunks. */
+  size_t nbEdges = 0;
+  for(size_t i = 0; i < nbChunks; i++) nbEdges += chunks[i].edges.size() / 2;
+
+  unsigned int* pending = kripke.reserveEdges(nbEdges);
+
+  for(size_t i = 0; i < nbChunks; i++) {
+
+    if(!chunks[i].edges.empty()) memcpy(pending, chunks[i].edges.data(), chunks[i].edges.size() * sizeof(unsigned int));
+
+    pending += chunks[i].edges.size();
+  }
+}
+
+/**
+ * @brief This method will count the 'v' lines of a chunk and look for its status lines (first pass).
+ *
+ * @param[in,out] chunk the chunk, its nbLines and status are filled.
+ */
+void KripkeReader::countLines(Chunk & chunk) {
+
+  chunk.nbLines = 0;
+  chunk.satisfiable = false;
+  chunk.unsatisfiable = false;
+
+  for(const char* p = chunk.begin; p < chunk.end; ) {
+
+    const char* eol = (const char*) memchr(p, '\n', chunk.end - p);
+    if(eol == NULL) eol = chunk.end;
+
+    if(p < eol && *p == 'v') chunk.nbLines++;
+
+    if(p < eol && *p == 's') {
+      int status = readStatus(p + 1, eol);
+      if(status < 0) chunk.unsatisfiable = true;
+      if(status > 0) chunk.satisfiable = true;
+    }
+
+    p = eol + 1;
+  }
+}
+
+/**
+ * @brief This method will parse the 'v' lines of a chunk (second pass).
+ *
+ * @param[in,out] chunk the chunk, its edges and late literals are filled.
+ */
+void KripkeReader::parseChunk(Chunk & chunk) {
+
+  unsigned int line = chunk.firstLine;
+  unsigned int nbVariablesInRows = kripke.getNbVariablesInRows();
+
+  /* The tokens can be decoded until the end of the chunk (the next chunk is only read). */
+  const char* limit = chunk.end;
+
+  for(const char* begin = chunk.begin; begin < chunk.end; ) {
+
+    const char* end = (const char*) memchr(begin, '\n', chunk.end - begin);
+    if(end == NULL) end = chunk.end;
+
+    if(begin < end && *begin == 'v') {
+
+      if(line < nbWorlds && deferRows) {
+
+        /* v l1 l2 ... 0 : parsed after the pruning, if the world is kept. */
+        rowLines[line] = begin;
+
+      } else if(line < nbWorlds) {
+
+        /* v l1 l2 ... 0 : no other thread writes in the row of this world. */
+        forEachToken(begin + 1, end, limit, [&](const char* token) {
+
+          int value = decodeInt(token,limit);
+
+          if(value == 0) return;
+
+          if((unsigned int) abs(value) <= nbVariablesInRows) kripke.assignValue(value,line);
+          else chunk.lateLiterals.push_back(make_pair(value,line));
+        });
+
+      } else {
+
+        /* v r1 wi wj */
+        unsigned int worlds[3] = {0, 0, 0};
+        readEdge(begin + 1, end, limit, worlds);
+
+        chunk.edges.push_back(worlds[1]);
+        chunk.edges.push_back(worlds[2]);
+      }
+
+      line++;
+    }
+
+    begin = end + 1;
+  }
+}
+
+/**
+ * @brief This method will check that the solution was complete, build the edges of the Kripke model and prune it.
+ */
+void KripkeReader::finish() {
+
+  if(!satFound) {
+    printf("ERROR: solution not in Kripke-CNF.\n");
+    exit(0);
+  }
+
+  kripke.buildEdges();
+
+  prune();
+}
+
+/**
+ * @brief This method will prune the Kripke model, then parse the valuation lines which were only located.
+ */
+void KripkeReader::prune() {
+
+  if(pruneDepth == Kripke::NO_PRUNING) return;
+
+  kripke.pruneUnreachable(pruneDepth);
+
+  if(!deferRows) return;
+
+  /* Only the lines of the worlds kept are parsed, in their new rows. */
+  for(unsigned int w = 0; w < kripke.getNbWorlds(); w++) {
+
+    const char* begin = rowLines[kripke.getOriginalId(w)];
+
+    if(begin == NULL) continue;
+
+    const char* end = (const char*) memchr(begin, '\n', mappedEnd - begin);
+    if(end == NULL) end = mappedEnd;
+
+    parseValuation(begin, end, mappedEnd, w);
+  }
+
+  vector<const char*>().swap(rowLines);
+}
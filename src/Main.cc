@@ -22,7 +22,10 @@
 ***************************************************************************************************/
 
 #include "../include/Formula.h"
+#include "../include/KripkeReader.h"
+#include "../include/Decompressor.h"
 
+#include <thread>
 #include <unistd.h>
 #include <sys/signal.h>
 
@@ -66,6 +69,11 @@ extern FILE *yyin;
  */
 #define LIMIT_ALARM 300
 
+/** 
+ * @brief By default, the cache of (sub-formula, world) results can use 512 MB.
+ */
+#define DEFAULT_CACHE_MB 512
+
 /**
  * \fn void catch_alarm(int sig)
  *
@@ -97,6 +105,43 @@ int main(int argc,char** argv) {
     clock_t begin,end;
     double timeParse;
 
+    /* If the BooleanOperations reorder their children while checking (recursive engine). */
+    bool adaptive = false;
+
+    /* If the children of the BooleanOperations are ordered by their expected cost in the model, before checking. */
+    bool costOrder = false;
+
+    /* If the diamonds check first the successors where they found their last witnesses (recursive engine). */
+    bool witnesses = false;
+
+    /* If the equal sub-formulae become one Term, and if the clauses of literals are checked in the valuation rows. */
+    bool sharing = true;
+    bool clauses = true;
+
+    /* If the modal operators over a literal read the aggregates of the successors of each world (recursive and parallel engines). */
+    bool aggregates = false;
+
+    /* How many MB the cache can use (0 means no cache), and if we display statistics. */
+    size_t cacheMB = DEFAULT_CACHE_MB;
+    bool verbose = false;
+
+    /* Which engine checks the formula: the recursive, parallel, iterative, bytecode, native or store one (top-down), or the labeling one (bottom-up). */
+    engine_t engine = E_RECURSIVE;
+
+    /* How many threads can be used (by default, one per core). */
+    unsigned int nbThreads = max(std::thread::hardware_concurrency(), 1u);
+
+    /* Where to write the model in the binary format (NULL if we do not convert it). */
+    const char* binaryPath = NULL;
+
+    /* If we keep only the worlds that the formula can see from w0. */
+    bool pruning = true;
+
+    /* If the bisimilar worlds are merged, and where to write the reduced model (NULL if we do not write it). */
+    bool bisimulation = false;
+    const char* reducedPath = NULL;
+    int opt;
+
 	/* We match the catch_alarm function as our manager of SIGARLM signals. */
     signal(SIGALRM, catch_alarm);
 
@@ -106,18 +151,94 @@ int main(int argc,char** argv) {
     /* We will for sure need a Kripke object to store the solution that we need to check. */
     Kripke solution;
 
+    /*
+     * The options are:
+     *
+     * -a        : adaptive mode, each AND (OR) checks first the children which were cheap and KO (OK) in the previous worlds (recursive engine,
+     *             it does nothing with '-e parallel').
+     * -b        : merge the bisimilar worlds before checking (the formula can not tell them apart).
+     * -C        : check the clauses of literals child by child (by default, they are compiled into masks of the valuation rows).
+     * -d        : each diamond checks first the successors where it found its last witnesses (recursive engine, the reverse edges
+     *             of the model are built for it, it does nothing with '-e parallel').
+     * -e ENGINE : 'recursive' (by default), 'labeling', 'parallel', 'iterative' (for a very deep formula), 'bytecode', 'native'
+     *             (compiled by $CXX into a shared object kept in ~/.cache/mdk-verifier, for a formula checked against many models,
+     *             if the verifier is built with WITH_NATIVE=1)
+     *             or 'store' (the formula as parallel arrays).
+     * -j N      : the number of threads (to parse a large solution file, and to check with the parallel engine).
+     * -m MB     : the memory budget of the cache (0 to disable it).
+     * -o        : order the children of every AND (OR) by their expected cost in the model (same result, but the reason of
+     *             a {KO,UNKNOWN} result may be given by another child).
+     * -P        : keep every world of the model (by default, the worlds further from w0 than the modal depth are pruned;
+     *             the valuations of the pruned worlds are never stored only if the solution is a text file, a solution
+     *             read on the STDIN, from a pipe, compressed or binary is fully loaded, then pruned).
+     * -r FILE   : write the model where the bisimilar worlds are merged, in the binary format.
+     * -S        : keep every sub-formula as it is written (by default, the equal sub-formulae become one Term).
+     * -s        : aggregate the assignations of the successors of every world, to check [r1]l and <r1>l in one test (recursive and parallel engines).
+     * -v        : display statistics about the checking.
+     * -w FILE   : write the model in the binary format, to be given instead of the solution the next times.
+     */
+    while((opt = getopt(argc,argv,"abCde:j:m:oPr:Ssvw:")) != -1) {
+
+        switch(opt) {
+
+            case 'a': adaptive = true; break;
+
+            case 'b': bisimulation = true; break;
+
+            case 'C': clauses = false; break;
+
+            case 'd': witnesses = true; break;
+
+            case 'e':
+                if(!strcmp(optarg,"labeling"))       engine = E_LABELING;
+                else if(!strcmp(optarg,"recursive")) engine = E_RECURSIVE;
+                else if(!strcmp(optarg,"parallel"))  engine = E_PARALLEL;
+                else if(!strcmp(optarg,"iterative")) engine = E_ITERATIVE;
+                else if(!strcmp(optarg,"bytecode"))  engine = E_BYTECODE;
+                else if(!strcmp(optarg,"native"))    engine = E_NATIVE;
+                else if(!strcmp(optarg,"store"))     engine = E_STORE;
+                else {
+                    fprintf(stderr,"Unknown engine '%s' (recursive, labeling, parallel, iterative, bytecode, native or store)\n",optarg);
+                    exit(-1);
+                }
+                break;
+
+            case 'j': nbThreads = max(atoi(optarg), 1); break;
+
+            case 'm': cacheMB = strtoul(optarg,NULL,10); break;
+
+            case 'o': costOrder = true; break;
+
+            case 'P': pruning = false; break;
+
+            case 'r': reducedPath = optarg; break;
+
+            case 'S': sharing = false; break;
+
+            case 's': aggregates = true; break;
+
+            case 'v': verbose = true; break;
+
+            case 'w': binaryPath = optarg; break;
+
+            default:
+                fprintf(stderr,"The checker should be called as follow: \ncat solution | %s [-a] [-b] [-C] [-d] [-e recursive|labeling|parallel|iterative|bytecode|native|store] [-j threads] [-m cacheMB] [-o] [-P] [-r reducedModel] [-S] [-s] [-v] [-w binaryModel] problem [solution]\n",argv[0]);
+                exit(-1);
+        }
+    }
+
     /* 
-     * We need one and only argument.  
-     * And this argument, should be the problem file. 
+     * We need one or two arguments.  
+     * The first one should be the problem file, the second one (if any) the solution file. 
      */
-    if(argc < 1) {
-        fprintf(stderr,"The checker should be called as follow: \ncat solution | %s problem\nor %s problem < solution\n",argv[0],argv[0]);
+    if(optind >= argc) {
+        fprintf(stderr,"The checker should be called as follow: \ncat solution | %s problem\nor %s problem < solution\nor %s problem solution\n",argv[0],argv[0],argv[0]);
         exit(-1);
     }
     
-    /* By default; the formula should be as the argv[1] argument of the main. */
-    if((yyin = fopen(argv[1],"r")) == NULL) {
-    	fprintf(stderr,"Problem with opening the formula file\nVerify the path of %s",argv[1]);
+    /* By default; the formula should be as the first argument (after the options) of the main (it may be compressed). */
+    if((yyin = Decompressor::openFile(argv[optind])) == NULL) {
+    	fprintf(stderr,"Problem with opening the formula file\nVerify the path of %s",argv[optind]);
     	exit(0);
     }
     
@@ -137,9 +258,10 @@ int main(int argc,char** argv) {
      *
      * [r1]a ^ [r1]b <=> [r1](a ^ b) 
      * 
-     * Then we will order children of each Term.
+     * Then we will order children of each Term, the sub-formulae appearing several times become one Term (unless -S),
+     * and the clauses of literals are compiled (unless -C).
      */
-    form->simplify();
+    form->simplify(sharing,clauses);
 
     /**
      * We will add the information about how long is the next "modal operator" chain from each Term.
@@ -155,8 +277,64 @@ int main(int argc,char** argv) {
     /* it will display the formula before and after simplification. */
 	// form->display();
 	
-    /* We start to parse the solution (that should came from STDIN). */
-	solution.parseSolutionFile();
+    /*
+     * Checked in w0, the formula can not see the worlds further than its modal depth.
+     * The models written are right for every formula, so the model is pruned only once they are written.
+     */
+    bool wholeModel = binaryPath != NULL || reducedPath != NULL;
+    unsigned int modalDepth = (pruning && !wholeModel) ? form->getModalDepth() : Kripke::NO_PRUNING;
+
+    /* We start to parse the solution (from the file given after the problem, or from STDIN). */
+    if(optind + 1 < argc) solution.parseSolutionFile(argv[optind+1],nbThreads,modalDepth);
+
+    else                  solution.parseSolutionFile(modalDepth);
+
+    if(binaryPath != NULL) solution.writeBinary(binaryPath);
+
+    if(reducedPath != NULL) {
+        solution.reduceBisimilar(Kripke::NO_PRUNING);
+        solution.writeBinary(reducedPath);
+    }
+
+    if(wholeModel && pruning) solution.pruneUnreachable(form->getModalDepth());
+
+    /* The worlds that the formula can not tell apart are checked once. */
+    if(bisimulation) solution.reduceBisimilar(form->getModalDepth());
+
+    /* The modal operators over a literal will not read the successors anymore. */
+    if(aggregates) solution.aggregateSuccessors();
+
+    /* The children which are cheap and likely to decide an AND (OR) in this model are checked first. */
+    if(costOrder) form->orderChildrenByCost(solution);
+
+    /* 
+     * Every sub-formula gets an id, and its result in a world will be stored in the cache.
+     * So a sub-formula is checked at most once per world.
+     */
+    unsigned int nbTerms = form->setTermIds();
+    CheckCache* cache = NULL;
+
+    if(cacheMB > 0) {
+        cache = new CheckCache(nbTerms,solution.getNbWorlds(),cacheMB << 20);
+        cache->setShared(engine == E_PARALLEL && nbThreads > 1);
+
+        if(!cache->isAllocated()) {
+            fprintf(stderr,"c not enough memory for the cache, the formula is checked without it\n");
+            delete cache;
+            cache = NULL;
+        }
+    }
+
+    /* Everything that the check writes (the reason of its result, its statistics) is in its context. */
+    CheckContext context(cache);
+
+    context.setAdaptive(adaptive);
+    context.setWitnesses(witnesses);
+
+    /* The threads share the formula, so its order of the children and its witnesses are not updated by the parallel engine. */
+    if(engine == E_PARALLEL && (adaptive || witnesses)) fprintf(stderr,"c -a and -d do nothing with the parallel engine\n");
+
+    unsigned int result;
 
     alarm(LIMIT_ALARM);
 
@@ -164,22 +342,52 @@ int main(int argc,char** argv) {
 	 * We can now start to check the formula with the given solution. 
 	 * There is only 3 exits possible: OK, KO and UNKNOWN.
 	 */
-	switch(form->checkFormula(solution)) {
+	switch(engine) {
+		case E_LABELING:  result = form->checkFormulaByLabeling(solution,context); break;
+		case E_PARALLEL:  result = form->checkFormulaInParallel(solution,nbThreads,context); break;
+		case E_ITERATIVE: result = form->checkFormulaIteratively(solution,context); break;
+		case E_BYTECODE:  result = form->checkFormulaCompiled(solution,context); break;
+		case E_NATIVE:    result = form->checkFormulaNatively(solution,context); break;
+		case E_STORE:     result = form->checkFormulaFromStore(solution,context,verbose); break;
+		default:          result = form->checkFormula(solution,context); break;
+	}
+
+	/* A {KO,UNKNOWN} result found in the cache gets the reason of its own check. */
+	if(result != OK) context.explainCachedReason(solution);
+
+	switch(result) {
 
 		case KO:
 			printf("ERROR: model is incorrect\n");
-			printf("%s\n",Term::getReasonUnchecked().c_str());
+			printf("%s\n",context.getReasonUnchecked(solution).c_str());
 			break;
 
 		case OK:
-			printf("OK %d\n",solution.getNbWorlds());
+			printf("OK %d\n",solution.getNbDeclaredWorlds());
 			break;
 
 		default:
-			printf("UNKNOWN: %s\n",Term::getReasonUnchecked().c_str());
+			printf("UNKNOWN: %s\n",context.getReasonUnchecked(solution).c_str());
 			break;
 	}
 
+	if(verbose && cache != NULL) {
+		cache->displayStatistics();
+		context.displayStatistics();
+	}
+
+	if(verbose && engine == E_RECURSIVE) printf("c terms checked : %llu\n",(unsigned long long) context.getNbChecks());
+
+	if(verbose && engine == E_LABELING) printf("c labeling kernel : %s\n",WorldSet::getKernelName());
+
+	if(verbose) printf("c parsing scanner : %s\n",KripkeReader::getScannerName());
+
+	if(verbose) printf("c terms shared : %u (%u distinct terms)\n",form->getNbShared(),nbTerms);
+
+	if(verbose) printf("c clauses compiled : %u\n",form->getNbCompiled());
+
+	if(verbose) printf("c worlds checked : %u / %u\n",solution.getNbWorlds(),solution.getNbDeclaredWorlds());
+
 	/* Everything went well, the program finished, we indicate it to the Operating System. */
     return EXIT_SUCCESS;
 }
\ No newline at end of file
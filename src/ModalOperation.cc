@@ -22,8 +22,13 @@
 ***************************************************************************************************/
 
 #include "../include/ModalOperation.h"
+#include "../include/TaskPool.h"
 
-#define SHRINK_CHAIN_OF_WORLDS true
+/* The labels are computed backward if the worlds where the child decides have less predecessors than 1/BACKWARD_RATIO of the edges. */
+#define BACKWARD_RATIO 4
+
+/* The successors of a world are shared in at most CHUNKS_PER_THREAD tasks per thread. */
+#define CHUNKS_PER_THREAD 4
 
 /**
  * \file ModalOperation.cc
@@ -54,10 +59,17 @@ ModalOperation::ModalOperation(Term* sub_formula, operator_t op) {
 	/* We set the operator if it is a Modal Operator. */
 	setOperator(op);
 
+	kind = K_MODAL;
+
 	Term::addChild(sub_formula);
 
 	/* For now, we don't deal with multi-agent, so we are agent 1 for sure. */
 	agent = 1;
+
+	/* No witness is known yet, the successors are first scanned in their order. */
+	witnessPosition = 0;
+	nextWitness = 0;
+	for(unsigned int j = 0; j < NB_WITNESS_WORLDS; j++) witnessWorlds[j] = NO_WITNESS;
 }
 
 /*
@@ -69,7 +81,9 @@ ModalOperation::ModalOperation(Term* sub_formula, operator_t op) {
  */
 ModalOperation::ModalOperation(ModalOperation& modOp) : Operation(modOp)  {
 
-	
+	witnessPosition = 0;
+	nextWitness = 0;
+	for(unsigned int j = 0; j < NB_WITNESS_WORLDS; j++) witnessWorlds[j] = NO_WITNESS;
 }
 
 /*
@@ -117,9 +131,7 @@ void ModalOperation::propagateInfoAboutModalChains(unsigned int & chainSize) {
 	/* We first go as far as possible in the depth. */
 	children[0]->propagateInfoAboutModalChains(chainSize);
 
-	ModalOperation* mod_op = dynamic_cast<ModalOperation*>(children[0]);
-
-	if(mod_op != NULL && (mod_op->getOperator() == getOperator())) {	
+	if(children[0]->getKind() == K_MODAL && (static_cast<ModalOperation*>(children[0])->getOperator() == getOperator())) {	
 
 		/* Here is the backTrack part, our child was chainSize * our operator, we so have a chain size of (chainSize+1). */
 		/* And our parent will have a chain size of (our size+1) ... */
@@ -193,17 +205,18 @@ void ModalOperation::boolAssociation() {
  *
  * w the world in which we are checking the satisfiability of the current ModalOperation.
  *
+ * context the context of the check (its reason is set if the result is {KO,UNKNOWN}).
+ *
  * return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current ModalOperation.
  * 
  */
-unsigned int ModalOperation::checkBranch(Kripke & kripke, unsigned int w) {
+unsigned int ModalOperation::checkBranch(Kripke & kripke, unsigned int w, CheckContext & context) {
 
 	/* We get all the worlds that we are connected with. */
-	vector<unsigned int>* worldConnected = kripke.getConnectedWorlds(w);
-	if(worldConnected == NULL) worldConnected = new vector<unsigned int>;
+	WorldSpan worldConnected = kripke.getConnectedWorlds(w);
 
 	/* We need to know how many there is. */
-	unsigned int size = worldConnected->size();
+	unsigned int size = worldConnected.size();
 	Term* check = this;	
 	unsigned int res = UNKNOWN;
 
@@ -217,36 +230,45 @@ unsigned int ModalOperation::checkBranch(Kripke & kripke, unsigned int w) {
 
 	if(SHRINK_CHAIN_OF_WORLDS) {
 
-  		unsigned int sizeOfChain = getModalTermChainSize();
-  		unsigned int w_tmp = w;
-  			
-  		while(sizeOfChain > 1 && size == 1) {
-
-  			w_tmp = kripke.nextWorld(w_tmp);
-		
-			size = kripke.getNbConnectedWorlds(w_tmp);
-
-			sizeOfChain--;
+		check = followChain(kripke,w);
 
-			check = check->getChild(0);
-	
-  		}	
-  	
-  		w = w_tmp;
-		worldConnected = kripke.getConnectedWorlds(w_tmp);		
+		worldConnected = kripke.getConnectedWorlds(w);
+		size = worldConnected.size();
 
 		// printf("We are checking : ");
 		// check->display();
 		// printf(" in w_%d\n",w);	
   	}
+
+	/* [r1]l and <r1>l are read in the aggregates of the successors of w. */
+	if(kripke.hasSuccessorAggregates()) {
+
+		res = checkFromAggregates(kripke,w,check->getChild(0));
+
+		if(res == OK) return OK;
+
+		if(res == UNKNOWN) {
+			context.setReason(this,NO_EDGE_IS_GIVING_WHAT_WE_SEARCH,w);
+			return UNKNOWN;
+		}
+	}
   	
 	/* We are checking <r1>PHI_w so we just need to find 1 world, connected to w, where PHI is true. */
 	if(getOperator() == O_DIAMOND) {
 
+		/* With -d, the last witnesses first (the reverse edges are built to know if a witness world is a successor of w). */
+		if(context.usesWitnesses() && size > 1) {
+
+			if(static_cast<ModalOperation*>(check)->checkDiamond(kripke,w,context) == OK) return OK;
+
+			context.setReason(this,NO_EDGE_IS_GIVING_WHAT_WE_SEARCH,w);
+			return UNKNOWN;
+		}
+
 		for(unsigned int i = 0; i < size; i++) {
  			
  			/* We are checking PHI in w_i */
-			res = check->getChild(0)->checkBranch(kripke,(*worldConnected)[i]);
+			res = check->getChild(0)->check(kripke,worldConnected[i],context);
 
 			/* If it is OK, then <r1>PHI is w is also OK. */
 			if(res == OK) {
@@ -258,7 +280,7 @@ unsigned int ModalOperation::checkBranch(Kripke & kripke, unsigned int w) {
 		 * We look through every connected world, and we didn't find an OK world. 
 		 * So we don't know and we indicate it with a reason. 
 		 */
-		Term::setReason(this,NO_EDGE_IS_GIVING_WHAT_WE_SEARCH,w);
+		context.setReason(this,NO_EDGE_IS_GIVING_WHAT_WE_SEARCH,w);
 	
 	} else {
 
@@ -267,7 +289,7 @@ unsigned int ModalOperation::checkBranch(Kripke & kripke, unsigned int w) {
 		for(unsigned int i = 0; i < size; i++) {
 
 			/* We are checking PHI in w_i */
-			res = check->getChild(0)->checkBranch(kripke,(*worldConnected)[i]);
+			res = check->getChild(0)->check(kripke,worldConnected[i],context);
 			
 			/* If it is KO, then [r1]PHI_w is KO */
 			if(res == KO) {
@@ -286,4 +308,451 @@ unsigned int ModalOperation::checkBranch(Kripke & kripke, unsigned int w) {
 	}
 	
 	return UNKNOWN;
-}
\ No newline at end of file
+}
+
+/*
+ * This method will check the ModalOperation in w from the aggregates of the successors of w, if the child to check is a literal.
+ *
+ * kripke the Kripke model, with its aggregates (see Kripke::aggregateSuccessors).
+ *
+ * w the world whose successors are read (once the chain of worlds is shrunk).
+ *
+ * child the child to check in the successors of w.
+ *
+ * return {OK,UNKNOWN} if the aggregates give the result, NOT_YET if the successors have to be checked.
+ */
+unsigned int ModalOperation::checkFromAggregates(Kripke & kripke, unsigned int w, Term* child) {
+
+	if(child->getKind() != K_VARIABLE) return NOT_YET;
+
+	unsigned int value = static_cast<PropositionalVariable*>(child)->getId();
+
+	if(getOperator() == O_DIAMOND) return kripke.isOKInSomeSuccessor(w,value,child->isNegated()) ? OK : UNKNOWN;
+
+	/* The first successor which is not OK gives the result of the box, and its reason. */
+	return kripke.isOKInEverySuccessor(w,value,child->isNegated()) ? OK : NOT_YET;
+}
+
+/*
+ * This method will check the child of the diamond in the successors of w, the last witnesses first.
+ *
+ * The successor at the place of the last witness is checked first, then the last witness worlds which are successors of w,
+ * then the other successors in their order. Same result as the scan of the successors in their order.
+ *
+ * kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * w the world whose successors are checked (once the chain of worlds is shrunk).
+ *
+ * context the context of the check.
+ *
+ * return OK if the child is OK in a successor of w, UNKNOWN otherwise (the reason is not set).
+ */
+unsigned int ModalOperation::checkDiamond(Kripke & kripke, unsigned int w, CheckContext & context) {
+
+	WorldSpan worldConnected = kripke.getConnectedWorlds(w);
+	unsigned int size = worldConnected.size();
+	Term* child = children[0];
+
+	/* The worlds already checked, the scan does not check them again. */
+	unsigned int probed[1 + NB_WITNESS_WORLDS];
+	unsigned int nbProbed = 0;
+
+	/* Sibling worlds often have their witness at the same place in their successors. */
+	if(witnessPosition < size) {
+
+		unsigned int v = worldConnected[witnessPosition];
+
+		if(child->check(kripke,v,context) == OK) { rememberWitness(witnessPosition,v); return OK; }
+
+		probed[nbProbed++] = v;
+	}
+
+	/* And they often share their witness (its place is not known, so it stays the same). */
+	for(unsigned int j = 0; j < NB_WITNESS_WORLDS; j++) {
+
+		unsigned int v = witnessWorlds[j];
+
+		if(v == NO_WITNESS || std::find(probed,probed + nbProbed,v) != probed + nbProbed || !kripke.isConnected(w,v)) continue;
+
+		if(child->check(kripke,v,context) == OK) return OK;
+
+		probed[nbProbed++] = v;
+	}
+
+	for(unsigned int i = 0; i < size; i++) {
+
+		unsigned int v = worldConnected[i];
+
+		if(std::find(probed,probed + nbProbed,v) != probed + nbProbed) continue;
+
+		if(child->check(kripke,v,context) == OK) { rememberWitness(i,v); return OK; }
+	}
+
+	return UNKNOWN;
+}
+
+/*
+ * This method will remember the successor where the child of the diamond was OK.
+ *
+ * position the index of the witness in the successors of the checked world.
+ *
+ * world the witness.
+ */
+void ModalOperation::rememberWitness(unsigned int position, unsigned int world) {
+
+	witnessPosition = position;
+
+	if(std::find(witnessWorlds,witnessWorlds + NB_WITNESS_WORLDS,world) != witnessWorlds + NB_WITNESS_WORLDS) return;
+
+	witnessWorlds[nextWitness] = world;
+	nextWitness = (nextWitness + 1) % NB_WITNESS_WORLDS;
+}
+
+/*
+ * This method will follow the worlds with only one successor, as long as the chain of modal operators goes on.
+ *
+ * kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * w the world where the chain starts, then the world where it stops.
+ *
+ * return the ModalOperation of the chain to check in the new w.
+ */
+Term* ModalOperation::followChain(Kripke & kripke, unsigned int & w) {
+
+	unsigned int sizeOfChain = getModalTermChainSize();
+	Term* check = this;
+
+	while(sizeOfChain > 1 && kripke.getNbConnectedWorlds(w) == 1) {
+
+		w = kripke.nextWorld(w);
+
+		sizeOfChain--;
+
+		check = check->getChild(0);
+	}
+
+	return check;
+}
+
+/*
+ * This method will compute, for every world of the solution kripke, if the ModalOperation is {OK,KO,UNKNOWN} in it.
+ * 
+ * The child is labeled once, then every edge of the Kripke model is read once.
+ *
+ * If the child is OK (for a diamond) or not OK (for a box) in only a few worlds, 
+ * we go instead from these worlds to their predecessors (the other worlds are UNKNOWN for a diamond, OK for a box).
+ *
+ * kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * labels labels[w] is {OK,KO,UNKNOWN} according to the labels of the child in the worlds connected to w.
+ *
+ * context the context of the check (its cache gets the labels of the Operations, see Term::storeLabels).
+ */
+void ModalOperation::labelWorlds(Kripke & kripke, WorldSet & labels, CheckContext & context) {
+
+	unsigned int nbWorlds = kripke.getNbWorlds();
+	WorldSet childLabels;
+
+	children[0]->labelWorlds(kripke,childLabels,context);
+
+	if(labelBackward(kripke,childLabels,labels)) {
+
+		storeLabels(kripke,labels,context);
+		return;
+	}
+
+	labels.assign(nbWorlds,UNKNOWN);
+
+	for(unsigned int w = 0; w < nbWorlds; w++) {
+
+		WorldSpan worldConnected = kripke.getConnectedWorlds(w);
+		unsigned int size = worldConnected.size();
+
+		if(getOperator() == O_DIAMOND) {
+
+			/* <r1>PHI is OK as soon as one connected world is OK, and we don't know otherwise. */
+			for(unsigned int i = 0; i < size; i++) {
+
+				if(childLabels.isOK(worldConnected[i])) { labels.set(w,OK); break; }
+			}
+
+		} else {
+
+			/* [r1]PHI is the first connected world which is not OK (KO or UNKNOWN), and OK if there is none. */
+			unsigned int res = OK;
+
+			for(unsigned int i = 0; i < size && res == OK; i++) res = childLabels.get(worldConnected[i]);
+
+			labels.set(w,res);
+		}
+	}
+
+	/* The reason is found from the labels once the root is labeled (see Formula::checkFormulaByLabeling). */
+	storeLabels(kripke,labels,context);
+}
+
+/*
+ * This method will compute the labels from the worlds where the child decides (OK for a diamond, not OK for a box) to their predecessors.
+ *
+ * It is done only if these worlds have less predecessors than BACKWARD_RATIO-th of the edges of the model.
+ *
+ * kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * childLabels the labels of the child in every world.
+ *
+ * labels labels[w] is {OK,KO,UNKNOWN} according to the labels of the child in the worlds connected to w.
+ *
+ * return true if the labels were computed, false if the edges have to be read forward.
+ */
+bool ModalOperation::labelBackward(Kripke & kripke, const WorldSet & childLabels, WorldSet & labels) {
+
+	unsigned int nbWorlds = kripke.getNbWorlds();
+	size_t budget = kripke.getNbEdges() / BACKWARD_RATIO;
+	size_t nbPredecessors = 0;
+	bool tooMany = false;
+
+	if(getOperator() == O_DIAMOND) {
+
+		/* <r1>PHI is OK in the predecessors of the worlds where PHI is OK, and UNKNOWN anywhere else. */
+		childLabels.forEachOK([&](unsigned int v) { if(!tooMany) tooMany = (nbPredecessors += kripke.getNbPredecessors(v)) > budget; });
+
+		if(tooMany) return false;
+
+		labels.assign(nbWorlds,UNKNOWN);
+
+		childLabels.forEachOK([&](unsigned int v) { for(unsigned int u : kripke.getPredecessors(v)) labels.set(u,OK); });
+
+		return true;
+	}
+
+	/* [r1]PHI is OK anywhere, but in the predecessors of the worlds where PHI is not OK. */
+	bool someKO = false, someUnknown = false;
+
+	childLabels.forEachNotOK(nbWorlds,[&](unsigned int v) {
+
+		if(tooMany) return;
+
+		tooMany = (nbPredecessors += kripke.getNbPredecessors(v)) > budget;
+
+		if(childLabels.get(v) == KO) someKO = true;
+		else                         someUnknown = true;
+	});
+
+	if(tooMany) return false;
+
+	labels.assign(nbWorlds,OK);
+
+	childLabels.forEachNotOK(nbWorlds,[&](unsigned int v) {
+
+		for(unsigned int u : kripke.getPredecessors(v)) {
+
+			if(!labels.isOK(u)) continue;
+
+			/* If PHI is never UNKNOWN (or never KO), the first world which is not OK is KO (or UNKNOWN). */
+			unsigned int res = someUnknown ? UNKNOWN : KO;
+
+			if(someKO && someUnknown) {
+				WorldSpan worldConnected = kripke.getConnectedWorlds(u);
+				res = OK;
+				for(unsigned int i = 0; i < worldConnected.size() && res == OK; i++) res = childLabels.get(worldConnected[i]);
+			}
+
+			labels.reset(u,res);
+		}
+	});
+
+	return true;
+}
+
+/**
+ * \struct SuccessorSearch
+ *
+ * @brief What the tasks of a ModalOperation share: the first successor which decides (OK for a diamond, not OK for a box).
+ */
+struct SuccessorSearch {
+
+    /** @brief The index of the first successor which decides (the number of successors while there is none). */
+    std::atomic<unsigned int> first;
+
+    /** @brief Protects result and reason. */
+    std::mutex lock;
+
+    /** @brief The result of the child in the first successor which decides. */
+    unsigned int result;
+
+    /** @brief The reason given by the check of the child in this successor. */
+    CheckReason reason;
+};
+
+/**
+ * \class SuccessorTask
+ *
+ * @brief The task checking the child of a ModalOperation in a range of successors, in their order.
+ */
+class SuccessorTask : public Task {
+
+public:
+
+    /**
+     * @brief To construct a task, we need the range of successors and the group of all the successors.
+     *
+     * @param[in] begin the index of the first successor of the range.
+     *
+     * @param[in] end after the index of the last successor of the range.
+     *
+     * @param[in] successors the group of all the tasks of the ModalOperation.
+     *
+     * @param[in] parent the context of the ModalOperation.
+     */
+    SuccessorTask(unsigned int begin, unsigned int end, TaskGroup & successors, const CheckContext & parent)
+      : begin(begin), end(end), aborted(~0u), inner(&successors), context(parent,inner) { }
+
+    /** @brief The first successor of the range. */
+    unsigned int begin;
+
+    /** @brief After the last successor of the range. */
+    unsigned int end;
+
+    /** @brief The index of the successor which was cancelled (~0 if none). */
+    unsigned int aborted;
+
+    /** @brief The group of the tasks given by the checks of the range. */
+    TaskGroup inner;
+
+    /** @brief The context of the task: its reason, its statistics, and the group of the range. */
+    CheckContext context;
+
+    /** @brief The child to check. */
+    Term* child;
+
+    /** @brief The Kripke model. */
+    Kripke* kripke;
+
+    /** @brief The successors. */
+    WorldSpan worlds;
+
+    /** @brief true for a diamond (OK decides), false for a box (not OK decides). */
+    bool diamond;
+
+    /** @brief What the tasks of the ModalOperation share. */
+    SuccessorSearch* search;
+
+    /** @brief The other tasks of the ModalOperation (to cancel the next ranges of a box). */
+    std::deque<SuccessorTask>* tasks;
+
+    /** @brief This method will check the child in each successor of the range, until one decides. */
+    virtual void run() {
+
+      for(unsigned int i = begin; i < end; i++) {
+
+        /* A previous successor already decides. */
+        if(i > search->first.load(std::memory_order_relaxed)) return;
+
+        unsigned int res = context.isCancelled() ? NOT_YET : child->checkInParallel(*kripke,worlds[i],context);
+
+        if(res == NOT_YET) { aborted = i; return; }
+
+        if((res == OK) != diamond) continue;
+
+        {
+          std::lock_guard<std::mutex> guard(search->lock);
+
+          if(i < search->first.load()) {
+            search->first.store(i);
+            search->result = res;
+            search->reason = context.getReason();
+          }
+        }
+
+        /* Any OK decides a diamond, but only the first successor which is not OK decides a box. */
+        for(size_t j = 0; j < tasks->size(); j++) {
+          if(diamond || (*tasks)[j].begin > i) (*tasks)[j].inner.cancel();
+        }
+
+        return;
+      }
+    }
+};
+
+/*
+ * This method will check the branch in the world w, the successors of w being shared in tasks of the pool of the context.
+ * 
+ * kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * w the world in which we are checking the satisfiability of the current ModalOperation.
+ *
+ * context the context of the current task (with a pool, and a group telling if the result is still needed).
+ *
+ * return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current ModalOperation, NOT_YET if the check was cancelled.
+ */
+unsigned int ModalOperation::checkBranchInParallel(Kripke & kripke, unsigned int w, CheckContext & context) {
+
+	Term* check = SHRINK_CHAIN_OF_WORLDS ? followChain(kripke,w) : this;
+
+	/* The aggregates are only read, every thread can use them. */
+	if(kripke.hasSuccessorAggregates()) {
+
+		unsigned int res = checkFromAggregates(kripke,w,check->getChild(0));
+
+		if(res == OK) return OK;
+
+		if(res == UNKNOWN) {
+			context.setReason(this,NO_EDGE_IS_GIVING_WHAT_WE_SEARCH,w);
+			return UNKNOWN;
+		}
+	}
+
+	TaskPool & pool = *context.getPool();
+	WorldSpan worldConnected = kripke.getConnectedWorlds(w);
+	unsigned int size = worldConnected.size();
+	unsigned int nbChunks = min(size, CHUNKS_PER_THREAD * pool.getNbThreads());
+	bool diamond = (getOperator() == O_DIAMOND);
+
+	SuccessorSearch search;
+	search.first = size;
+
+	TaskGroup successors(context.getGroup());
+	std::deque<SuccessorTask> tasks;
+
+	for(unsigned int i = 0; i < nbChunks; i++) {
+
+		tasks.emplace_back((uint64_t) size * i / nbChunks, (uint64_t) size * (i+1) / nbChunks, successors, context);
+
+		tasks.back().child = check->getChild(0);
+		tasks.back().kripke = &kripke;
+		tasks.back().worlds = worldConnected;
+		tasks.back().diamond = diamond;
+		tasks.back().search = &search;
+		tasks.back().tasks = &tasks;
+	}
+
+	/* The first range is checked by the current thread, the other ones can be stolen. */
+	for(unsigned int i = 1; i < nbChunks; i++) pool.spawn(&tasks[i],successors);
+	if(nbChunks > 0) tasks[0].run();
+	pool.wait(successors);
+
+	for(unsigned int i = 0; i < nbChunks; i++) context.addStatistics(tasks[i].context);
+
+	unsigned int first = search.first.load();
+
+	/* Any OK decides a diamond. */
+	if(diamond && first < size) return OK;
+
+	/* A successor before the one which decides was not checked: the ModalOperation was cancelled from above. */
+	for(unsigned int i = 0; i < nbChunks; i++) {
+		if(tasks[i].aborted < first) return NOT_YET;
+	}
+
+	if(diamond) {
+		context.setReason(this,NO_EDGE_IS_GIVING_WHAT_WE_SEARCH,w);
+		return UNKNOWN;
+	}
+
+	/* The first successor which is not OK gives the result of the box, and its reason. */
+	if(first < size) {
+		context.setReason(search.reason);
+		return search.result;
+	}
+
+	return OK;
+}
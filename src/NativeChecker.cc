@@ -0,0 +1,404 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+
+/**
+ * \file NativeChecker.cc
+ * @brief Implementation of NativeChecker::methods which are not in the NativeChecker.h
+ *
+ * @version 1.0
+ */
+
+#include "../include/NativeChecker.h"
+
+#include <stdarg.h>
+
+#ifdef WITH_NATIVE
+#include <dlfcn.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#endif
+
+/** @brief The compiler used to build the generated checkers, when $CXX is not set (given by the Makefile). */
+#ifndef NATIVE_CXX
+#define NATIVE_CXX "g++"
+#endif
+
+/** @brief The directory of the headers included by the generated checkers (given by the Makefile). */
+#ifndef NATIVE_INCLUDE
+#define NATIVE_INCLUDE "./include"
+#endif
+
+/**
+ * @brief The beginning of every generated checker.
+ *
+ * L tests a literal and gives the same reasons as PropositionalVariable::checkBranch,
+ * CACHED wraps the body of an Operation with the cache, like Term::check.
+ */
+static const char* PRELUDE =
+  "/* Generated by mdk-verifier for one formula (see NativeChecker.h). */\n"
+  "#include \"Kripke.h\"\n"
+  "#include \"CheckContext.h\"\n"
+  "\n"
+  "static Term* const* T;\n"
+  "\n"
+  "static inline __attribute__((always_inline)) unsigned int L(Kripke & k, unsigned int w, unsigned int v, bool n, unsigned int pc, CheckContext & c) {\n"
+  "  unsigned int r = k.checkLiteral(w,v,n);\n"
+  "  if(r == KO)      c.setReason(T[pc],NOT_VAR_FOUND_BUT_OPPOSITE,w);\n"
+  "  if(r == UNKNOWN) c.setReason(T[pc],NOT_VAR_FOUND_NEITHER_OPPPOSITE,w);\n"
+  "  return r;\n"
+  "}\n"
+  "\n"
+  "#define CACHED(pc,id) \\\n"
+  "static unsigned int f##pc(Kripke & k, unsigned int w, CheckContext & c) { \\\n"
+  "  if(c.getCache() == NULL) return b##pc(k,w,c); \\\n"
+  "  unsigned int r = c.lookup(id,w,T[pc]); \\\n"
+  "  if(r == NOT_YET) { r = b##pc(k,w,c); c.getCache()->store(id,w,r); } \\\n"
+  "  return r; \\\n"
+  "}\n";
+
+/**
+ * @brief To construct a NativeChecker, we need the root of the simplified formula (with its chains and its ids).
+ *
+ * @param[in] root the root of the formula.
+ */
+NativeChecker::NativeChecker(Term* root) : program(root), handle(NULL), function(NULL) {
+
+  source = PRELUDE;
+
+  generate(0);
+
+  emit("\nextern \"C\" unsigned int mdk_check(Kripke & k, unsigned int w, CheckContext & c, Term* const* terms) {\n");
+  emit("  T = terms;\n");
+  emit("  return %s;\n", expression(0,"w").c_str());
+  emit("}\n");
+}
+
+/**
+ * @brief This method is the destructor, it will unload the shared object.
+ */
+NativeChecker::~NativeChecker() {
+
+#ifdef WITH_NATIVE
+  if(handle != NULL) dlclose(handle);
+#endif
+}
+
+/**
+ * @brief This method will append printf-like formatted text to the source.
+ *
+ * @param[in] format the format, followed by its arguments.
+ */
+void NativeChecker::emit(const char* format, ...) {
+
+  char buffer[256];
+  va_list args;
+
+  va_start(args, format);
+  int n = vsnprintf(buffer, sizeof(buffer), format, args);
+  va_end(args);
+
+  /* Only the expressions are longer than the buffer, they are appended with %s. */
+  if(n >= (int) sizeof(buffer)) {
+    vector<char> large(n + 1);
+    va_start(args, format);
+    vsnprintf(&large[0], large.size(), format, args);
+    va_end(args);
+    source.append(&large[0], n);
+  }
+  else source.append(buffer, n);
+}
+
+/**
+ * @brief This method will return the C++ expression checking the instruction pc in the world 'world'.
+ *
+ * @param[in] pc the index of the instruction.
+ *
+ * @param[in] world the name of the variable holding the world.
+ *
+ * @return a literal test, a constant or the call of the function of an Operation.
+ */
+string NativeChecker::expression(uint32_t pc, const char* world) const {
+
+  const Instruction & i = program.getInstruction(pc);
+  char buffer[128];
+
+  switch(i.opcode) {
+
+    case I_LITERAL: snprintf(buffer, sizeof(buffer), "L(k,%s,%u,%u,%u,c)", world, i.arg, i.negated, pc); break;
+    case I_TRUE:    snprintf(buffer, sizeof(buffer), "OK"); break;
+    case I_FALSE:   snprintf(buffer, sizeof(buffer), "KO"); break;
+    default:        snprintf(buffer, sizeof(buffer), "f%u(k,%s,c)", pc, world); break;
+  }
+
+  return buffer;
+}
+
+/**
+ * @brief This method will append the functions of the instruction pc and of its descendants (the descendants first).
+ *
+ * @param[in] pc the index of the instruction.
+ */
+void NativeChecker::generate(uint32_t pc) {
+
+  const Instruction & i = program.getInstruction(pc);
+
+  if(i.opcode < I_AND) return;
+
+  /* The functions are defined before they are called, so no declaration is needed. */
+  for(uint32_t child = pc + 1; child < i.skip; child = program.getInstruction(child).skip) generate(child);
+
+  emit("\nstatic unsigned int b%u(Kripke & k, unsigned int w, CheckContext & c) {\n", pc);
+  emit("  unsigned int r;\n");
+
+  if(i.opcode == I_AND || i.opcode == I_OR) {
+
+    emit("  bool unknown = false;\n");
+    if(i.opcode == I_OR) emit("  bool ko = false;\n");
+
+    /* One test per child, with the short-circuit of BooleanOperation::checkBranch. */
+    for(uint32_t child = pc + 1; child < i.skip; child = program.getInstruction(child).skip) {
+
+      emit("  r = %s;\n", expression(child,"w").c_str());
+
+      if(i.opcode == I_AND) emit("  if(r == KO) return KO;\n");
+      else                  emit("  if(r == OK) return OK;\n  ko |= (r == KO);\n");
+
+      emit("  unknown |= (r == UNKNOWN);\n");
+    }
+
+    if(i.opcode == I_AND) {
+      emit("  if(!unknown) return OK;\n");
+      emit("  c.setReason(T[%u],UNKNOWN_AND_UNKNOWN,w);\n", pc);
+    }
+    else {
+      emit("  if(!unknown) return KO;\n");
+      emit("  c.setReason(T[%u],ko ? UNKNOWN_OR_KO : UNKNOWN_OR_UNKNOWN,w);\n", pc);
+    }
+
+    emit("  return UNKNOWN;\n}\n");
+  }
+
+  else {
+
+    /* Like ModalOperation::followChain, then one loop over the successors per number of worlds followed. */
+    emit("  unsigned int s = 0;\n");
+
+    if(i.arg > 1) emit("  for(; s < %u && k.getNbConnectedWorlds(w) == 1; s++) w = k.nextWorld(w);\n", i.arg - 1);
+
+    emit("  WorldSpan ws = k.getConnectedWorlds(w);\n");
+    emit("  switch(s) {\n");
+
+    for(uint32_t s = 0; s < max(i.arg, 1u); s++) {
+
+      emit("    case %u:\n", s);
+      emit("      for(const unsigned int* v = ws.begin(); v != ws.end(); v++) {\n");
+      emit("        r = %s;\n", expression(pc + 1 + s,"*v").c_str());
+
+      if(i.opcode == I_DIAMOND) emit("        if(r == OK) return OK;\n");
+      else                      emit("        if(r != OK) return r;\n");
+
+      emit("      }\n      break;\n");
+    }
+
+    emit("  }\n");
+
+    if(i.opcode == I_DIAMOND) emit("  c.setReason(T[%u],NO_EDGE_IS_GIVING_WHAT_WE_SEARCH,w);\n  return UNKNOWN;\n}\n", pc);
+    else                      emit("  return OK;\n}\n");
+  }
+
+  emit("CACHED(%u,%u)\n", pc, i.termId);
+}
+
+#ifdef WITH_NATIVE
+/**
+ * @brief This function will create the directory if it does not exist, and tell if only the current user can write in it.
+ *
+ * @param[in] dir the path of the directory.
+ *
+ * @return true if the directory belongs to the current user and nobody else can write in it.
+ */
+static bool privateDirectory(const string & dir) {
+
+  struct stat st;
+
+  if(mkdir(dir.c_str(), 0700) != 0 && errno != EEXIST) return false;
+
+  return lstat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == getuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+}
+
+/**
+ * @brief This function will tell if a shared object can be loaded: a regular file of the current user that nobody else can write.
+ *
+ * @param[in] path the path of the shared object.
+ *
+ * @return true if the shared object can be loaded.
+ */
+static bool trustedObject(const string & path) {
+
+  struct stat st;
+  int fd = open(path.c_str(), O_RDONLY | O_NOFOLLOW);
+
+  if(fd < 0) return false;
+
+  bool trusted = fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_uid == getuid() && (st.st_mode & (S_IWGRP | S_IWOTH)) == 0;
+
+  close(fd);
+
+  return trusted;
+}
+
+/**
+ * @brief This function will build a shared object with the compiler cxx, run without any shell.
+ *
+ * @param[in] cxx the compiler.
+ *
+ * @param[in] code the path of the C++ source.
+ *
+ * @param[in] object the path of the shared object.
+ *
+ * @return true if the compiler succeeded.
+ */
+static bool compile(const char* cxx, const string & code, const string & object) {
+
+  string include = string("-I") + NATIVE_INCLUDE;
+  const char* argv[] = { cxx, "-O2", "-std=c++11", "-fPIC", "-shared", include.c_str(), "-o", object.c_str(), code.c_str(), NULL };
+  int status = 0;
+  pid_t pid = fork();
+
+  if(pid < 0) return false;
+
+  if(pid == 0) {
+    execvp(cxx, (char* const*) argv);
+    _exit(127);
+  }
+
+  /* The alarm of the time limit may interrupt the wait. */
+  while(waitpid(pid, &status, 0) < 0) if(errno != EINTR) return false;
+
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+#endif
+
+/**
+ * @brief This method will build the shared object (if it is not already built) and load it.
+ *
+ * @return true if the generated checker can be used, false if it can not be built or loaded.
+ */
+bool NativeChecker::load() {
+
+#ifdef WITH_NATIVE
+
+  /* FNV-1a of the source and of the build of the verifier (rebuilt when the headers included by the source change). */
+  uint64_t hash = 14695981039346656037ULL;
+  string key = source + __DATE__ " " __TIME__;
+
+  for(size_t i = 0; i < key.size(); i++) hash = (hash ^ (unsigned char) key[i]) * 1099511628211ULL;
+
+  const char* cache = getenv("XDG_CACHE_HOME");
+  const char* home = getenv("HOME");
+  const char* cxx = getenv("CXX");
+  string dir;
+
+  if(cxx == NULL || *cxx == '\0') cxx = NATIVE_CXX;
+
+  if(cache != NULL && *cache != '\0') dir = cache;
+  else if(home != NULL && *home != '\0') {
+    dir = string(home) + "/.cache";
+    mkdir(dir.c_str(), 0700);
+  }
+
+  if(!dir.empty()) dir += "/mdk-verifier";
+
+  /* Without a private cache directory, the checker is built in a new directory, removed once it is loaded. */
+  bool temporary = dir.empty() || !privateDirectory(dir);
+
+  if(temporary) {
+
+    const char* tmp = getenv("TMPDIR");
+    string pattern = string((tmp == NULL || *tmp == '\0') ? "/tmp" : tmp) + "/mdk-native-XXXXXX";
+    vector<char> path(pattern.begin(), pattern.end());
+
+    path.push_back('\0');
+
+    if(mkdtemp(&path[0]) == NULL) return false;
+
+    dir = &path[0];
+  }
+
+  char name[64];
+  snprintf(name, sizeof(name), "/mdk-native-%016llx", (unsigned long long) hash);
+
+  string base = dir + name;
+  string object = base + ".so";
+
+  if(temporary || !trustedObject(object)) {
+
+    /* Built under other names, then renamed: another verifier never loads a half-written object. */
+    string code = base + "." + to_string((int) getpid()) + ".cc";
+    string partial = base + "." + to_string((int) getpid()) + ".so";
+    int fd = open(code.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW, 0600);
+
+    if(fd < 0) {
+      if(temporary) rmdir(dir.c_str());
+      return false;
+    }
+
+    bool built = write(fd, source.data(), source.size()) == (ssize_t) source.size();
+
+    built = close(fd) == 0 && built;
+    built = built && compile(cxx, code, partial);
+    built = built && chmod(partial.c_str(), 0700) == 0 && rename(partial.c_str(), object.c_str()) == 0;
+
+    remove(code.c_str());
+
+    if(!built) {
+      remove(partial.c_str());
+      if(temporary) rmdir(dir.c_str());
+      return false;
+    }
+  }
+
+  if(trustedObject(object)) handle = dlopen(object.c_str(), RTLD_NOW | RTLD_LOCAL);
+
+  /* A loaded object stays mapped once its file is removed. */
+  if(temporary) {
+    remove(object.c_str());
+    rmdir(dir.c_str());
+  }
+
+  if(handle == NULL) return false;
+
+  function = (native_t) dlsym(handle, "mdk_check");
+
+  return function != NULL;
+#else
+  fprintf(stderr,"c the verifier was built without the native checker (make WITH_NATIVE=1)\n");
+
+  return false;
+#endif
+}
@@ -56,6 +56,8 @@ PropositionalVariable::PropositionalVariable(PropositionalVariable& term) : Vari
  */
 PropositionalVariable::PropositionalVariable(char* value) : Variable(value) {
 
+	kind = K_VARIABLE;
+
 	/* What is send to this function is basically [p]{DIGIT}+, so we need to remove the 'p'. */
 	unsigned int val = atoi(value+1);
 	
@@ -75,9 +77,11 @@ PropositionalVariable::PropositionalVariable(char* value) : Variable(value) {
  *
  * @param[in] world the world in which we are checking the satisfiability of the current PropositionalVariable.
  *
+ * @param[in,out] context the context of the check (its reason is set if the result is {KO,UNKNOWN}).
+ *
  * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current PropositionalVariable.
  */
-unsigned int PropositionalVariable::checkBranch(Kripke & kripke, unsigned int world) {
+unsigned int PropositionalVariable::checkBranch(Kripke & kripke, unsigned int world, CheckContext & context) {
 
 	/*
 	printf("We are checking : ");
@@ -85,26 +89,40 @@ unsigned int PropositionalVariable::checkBranch(Kripke & kripke, unsigned int wo
 	printf(" in w_%d\n",world);
 	*/
 
-	/* First, we want to check if the case [world][identifier] contains 1 in kripke. */
-	char checkValue = 1;
-	
-	/* If we are checking negatively, we don't want to have an '1' but a '-1' */
-	if(isNegated()) checkValue = -1;
-
-	/* We get the stored value in the Kripke model at [world][identifier] */
-	char storedValue = kripke.getAssignedValue(world,identifier);
+	/* We check in one test if [world][identifier] contains 1 (-1 if we are negated) in kripke. */
+	unsigned int res = kripke.checkLiteral(world,identifier,isNegated());
 
 	/* If it is matching, then it is OK */
-	if(storedValue == checkValue) return OK;
+	if(res == OK) return OK;
 
 	/* If we have the opposite, then we indicate it. */
-	else if(-storedValue == checkValue) {
+	else if(res == KO) {
 		    
-		Term::setReason(this,NOT_VAR_FOUND_BUT_OPPOSITE,world);
+		context.setReason(this,NOT_VAR_FOUND_BUT_OPPOSITE,world);
 		return KO;
 	}
 
-	/* If not, it means that storedValue is 0 and then we still don't know if it's OK or KO. So it's UNKNOWN. */
-	Term::setReason(this,NOT_VAR_FOUND_NEITHER_OPPPOSITE,world);
+	/* If not, it means that the atom is not assigned in world and then we still don't know if it's OK or KO. So it's UNKNOWN. */
+	context.setReason(this,NOT_VAR_FOUND_NEITHER_OPPPOSITE,world);
 	return UNKNOWN;
+}
+
+/**
+ * @brief This method will compute, for every world of the solution kripke, if the PropositionalVariable is {OK,KO,UNKNOWN} in it.
+ * 
+ * The labels are just the bitsets of the worlds where the variable is assigned, swapped if we are negated.
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * @param[out] labels labels[w] is {OK,KO,UNKNOWN} according to the assignation of the PropositionalVariable in w.
+ *
+ * @param[in,out] context the context of the check (its cache gets the labels of the Operations, see Term::storeLabels).
+ */
+void PropositionalVariable::labelWorlds(Kripke & kripke, WorldSet & labels, CheckContext & context) {
+
+	unsigned int nbWorlds = kripke.getNbWorlds();
+
+	labels.assign(nbWorlds,kripke.getWorldsWhereTrue(identifier),kripke.getWorldsWhereFalse(identifier));
+
+	if(isNegated()) labels.negate();
 }
\ No newline at end of file
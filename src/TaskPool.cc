@@ -0,0 +1,197 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+/**
+ * \file TaskPool.cc
+ * @brief Implementation of TaskPool::methods which are not in the TaskPool.h
+ *
+ * @version 1.0
+ */
+
+#include "../include/TaskPool.h"
+
+/** @brief How many times a thread without task looks for one before sleeping. */
+#define SPINS_BEFORE_SLEEP 64
+
+thread_local unsigned int TaskPool::workerIndex = 0;
+
+/**
+ * @brief To construct a pool, we need how many threads (the calling one included) run the tasks.
+ *
+ * @param[in] nbThreads the number of threads (at least 1).
+ */
+TaskPool::TaskPool(unsigned int nbThreads) : queued(0), nbSleeping(0), stopping(false) {
+
+  this->nbThreads = (nbThreads > 0) ? nbThreads : 1;
+
+  for(unsigned int i = 0; i < this->nbThreads; i++) workers.push_back(new Worker());
+
+  /* The calling thread is the first thread of the pool. */
+  workerIndex = 0;
+
+  for(unsigned int i = 1; i < this->nbThreads; i++) threads.push_back(std::thread(&TaskPool::workerLoop, this, i));
+}
+
+/**
+ * @brief This method is the destructor, it will stop and join the threads of the pool.
+ */
+TaskPool::~TaskPool() {
+
+  {
+    std::lock_guard<std::mutex> guard(sleepLock);
+    stopping = true;
+  }
+
+  wakeUp.notify_all();
+
+  for(size_t i = 0; i < threads.size(); i++) threads[i].join();
+
+  for(size_t i = 0; i < workers.size(); i++) delete workers[i];
+}
+
+/**
+ * @brief This method will give a task to the pool.
+ *
+ * @param[in] task the task (it has to live until TaskPool::wait returns for its group).
+ *
+ * @param[in] group the group of the task.
+ */
+void TaskPool::spawn(Task* task, TaskGroup & group) {
+
+  task->group = &group;
+  group.pending.fetch_add(1, std::memory_order_relaxed);
+
+  {
+    Worker* self = workers[workerIndex];
+    std::lock_guard<std::mutex> guard(self->lock);
+    self->tasks.push_back(task);
+  }
+
+  queued.fetch_add(1);
+
+  /* A sleeping thread checks 'queued' under sleepLock, so it can not miss this task. */
+  if(nbSleeping.load() > 0) {
+    { std::lock_guard<std::mutex> guard(sleepLock); }
+    wakeUp.notify_one();
+  }
+}
+
+/**
+ * @brief This method will return a task to run: the last one of the thread, or one stolen to another thread.
+ *
+ * @return a task, or NULL if there is none.
+ */
+Task* TaskPool::take() {
+
+  if(queued.load(std::memory_order_relaxed) == 0) return NULL;
+
+  /* First our own tasks, the last spawned first. */
+  {
+    Worker* self = workers[workerIndex];
+    std::lock_guard<std::mutex> guard(self->lock);
+
+    if(!self->tasks.empty()) {
+      Task* task = self->tasks.back();
+      self->tasks.pop_back();
+      queued.fetch_sub(1);
+      return task;
+    }
+  }
+
+  /* Then the oldest task of another thread, starting with the next one. */
+  for(unsigned int i = 1; i < nbThreads; i++) {
+
+    Worker* victim = workers[(workerIndex + i) % nbThreads];
+    std::lock_guard<std::mutex> guard(victim->lock);
+
+    if(!victim->tasks.empty()) {
+      Task* task = victim->tasks.front();
+      victim->tasks.pop_front();
+      queued.fetch_sub(1);
+      return task;
+    }
+  }
+
+  return NULL;
+}
+
+/**
+ * @brief This method will run a task, and tell its group that it is finished.
+ *
+ * @param[in] task the task to run.
+ */
+void TaskPool::execute(Task* task) {
+
+  TaskGroup* group = task->group;
+
+  task->run();
+
+  /* The waiting thread reads what the task wrote once it sees the counter at 0. */
+  group->pending.fetch_sub(1, std::memory_order_release);
+}
+
+/**
+ * @brief This method will run tasks until every task of the group is finished.
+ *
+ * @param[in] group the group that we wait for.
+ */
+void TaskPool::wait(TaskGroup & group) {
+
+  while(group.pending.load(std::memory_order_acquire) > 0) {
+
+    Task* task = take();
+
+    if(task != NULL) execute(task);
+    else             std::this_thread::yield();
+  }
+}
+
+/**
+ * @brief This method is the loop of the threads of the pool, until the pool is destroyed.
+ *
+ * @param[in] index the index of the thread in the pool.
+ */
+void TaskPool::workerLoop(unsigned int index) {
+
+  unsigned int idle = 0;
+
+  workerIndex = index;
+
+  while(!stopping.load()) {
+
+    Task* task = take();
+
+    if(task != NULL) { execute(task); idle = 0; continue; }
+
+    if(++idle < SPINS_BEFORE_SLEEP) { std::this_thread::yield(); continue; }
+
+    /* Nothing to do for a while: we sleep until a task is spawned. */
+    std::unique_lock<std::mutex> guard(sleepLock);
+
+    nbSleeping.fetch_add(1);
+    wakeUp.wait(guard, [this] { return stopping.load() || queued.load() > 0; });
+    nbSleeping.fetch_sub(1);
+
+    idle = 0;
+  }
+}
@@ -23,12 +23,6 @@
 
 #include "../include/PropositionalVariable.h"
 
-Term* Term::nodeReason = NULL;
-
-unsigned int Term::code = NO_REASON_FOUND;
-
-unsigned int Term::worldReason = 0;
-
 /**
  * \file Term.cc
  * @brief Implementation of Term::methods which are not in the Term.h
@@ -38,83 +32,114 @@ unsigned int Term::worldReason = 0;
  * @date 15/03/2016
  */
 
+unsigned long long Term::nbCreated = 0;
+
 /**
- * @brief according to the code stored and the pointer of the Term*, this method will return an adapted message.
+ * @brief This method will delete the i-th child of the current Term.
  * 
- * @return an adapted message according to the code and the Term* stored statically.
+ * @param[in] i the index of the child that we want to delete
+ *
+ * @note this function is O(1).
  */
- string Term::getReasonUnchecked() {
+void Term::deleteChild(unsigned int i) {
 
-  string reason;
+  /* To delete the i-th, we just swap the i-th with the last one. */
+  std::swap(children[i], children.back());
 
-    switch(Term::code) {
+  /* and then we pop the last one out of the list. */
+  children.pop_back();
 
-        case NOT_VAR_FOUND_BUT_OPPOSITE:
+}
 
-            if(Term::nodeReason->isNegated()) reason.append("~");
+/**
+ * @brief This method will check the Term in the world w, giving parts of the work to the other threads of the pool of the context.
+ * 
+ * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * @param[in] w the world in which we are checking the satisfiability of the current Term.
+ *
+ * @param[in,out] context the context of the current task (with a pool, and a group telling if the result is still needed).
+ *
+ * @return {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current Term, NOT_YET if the check was cancelled.
+ */
+unsigned int Term::checkInParallel(Kripke & kripke, unsigned int w, CheckContext & context) {
 
-            if(PropositionalVariable* p = dynamic_cast<PropositionalVariable*>(Term::nodeReason))
-                reason.append("p" + to_string(p->getId()) + " is not in w_" + to_string(Term::worldReason) + " but its negation is !\n");
+  /* If every thread has enough to do, giving more tasks would only cost time (and a clause of literals is one test). */
+  if(children.empty() || !cached || context.getPool()->isBusy()) return check(kripke,w,context);
 
-            break;  
+  if(context.isCancelled()) return NOT_YET;
 
-        case NOT_VAR_FOUND_NEITHER_OPPPOSITE:
+  CheckCache* cache = context.getCache();
+  unsigned int res = (cache != NULL) ? context.lookup(termId,w,this) : NOT_YET;
 
-            if(Term::nodeReason->isNegated()) reason.append("~");
+  if(res == NOT_YET) {
 
-            if(PropositionalVariable* p = dynamic_cast<PropositionalVariable*>(Term::nodeReason))
-                reason.append("p" + to_string(p->getId()) + "is not in w_" + to_string(Term::worldReason) + "(nor its negation) \n");
-            break;
+    res = checkBranchInParallel(kripke,w,context);
 
-        case NO_EDGE_IS_GIVING_WHAT_WE_SEARCH:
-            reason.append("No World accessible by w_" + to_string(Term::worldReason) + " contains what we want...\n");
-            break;
+    /* A cancelled check has no result to store. */
+    if(res != NOT_YET && cache != NULL) cache->store(termId,w,res);
+  }
 
-        case UNKNOWN_OR_KO:
-            reason.append("At least one part of an OR is wrong in w_" + to_string(Term::worldReason)+ " and the rest is UNKNOWN...\n");
-            break;
+  return res;
+}
 
-        case UNKNOWN_OR_UNKNOWN:
-            reason.append("All the branches of an OR are UNKNOWN in w_" + to_string(Term::worldReason)+ "...\n");
-            break;
+/**
+ * @brief This method will store the labels of the Term in the cache of the context, if its results are stored there.
+ *
+ * @param[in] kripke the Kripke model which is (or not) the solution of the current formula.
+ *
+ * @param[in] labels labels[w] is {OK,KO,UNKNOWN} according to the satisfiabiltiy of the current Term in w.
+ *
+ * @param[in,out] context the context of the check (its cache gets the labels).
+ */
+void Term::storeLabels(Kripke & kripke, const WorldSet & labels, CheckContext & context) {
 
-        case UNKNOWN_AND_UNKNOWN:
-            reason.append("All the branches of an AND are UNKNOWN in w_" + to_string(Term::worldReason)+ "...\n");
-            break;
+  CheckCache* cache = context.getCache();
 
-        default:
-            reason = "\n";
-            break;
+  /* Same Terms as the ones looked for by Term::check. */
+  if(cache == NULL || children.empty() || !cached) return;
 
-    }
+  unsigned int nbWorlds = kripke.getNbWorlds();
 
-    return reason;
+  for(unsigned int w = 0; w < nbWorlds; w++) cache->store(termId,w,labels.get(w));
 }
 
 /**
- * @brief This method will delete the i-th child of the current Term.
+ * @brief This method will recursively give an id to the Term and all its sub-formulae.
  * 
- * @param[in] i the index of the child that we want to delete
- *
- * @note this function is O(1).
+ * @param[in] nextId the next id available, it will be increased for each Term.
  */
-void Term::deleteChild(unsigned int i) {
+void Term::setTermIds(unsigned int & nextId) {
 
-  /* To delete the i-th, we just swap the i-th with the last one. */
-  std::swap(children[i], children.back());
+    /* A shared sub-formula already got its id (and its sub-formulae too). */
+    if(termId != NO_ID) return;
 
-  /* and then we pop the last one out of the list. */
-  children.pop_back();
+    termId = nextId++;
+
+    size_t size = children.size();
+
+    for(unsigned int i = 0; i < size; i++) children[i]->setTermIds(nextId);
+}
+
+/**
+ * @brief This method will recursively give the id NO_ID to the Term and all its sub-formulae.
+ */
+void Term::clearTermIds() {
 
+    if(termId == NO_ID) return;
+
+    termId = NO_ID;
+
+    size_t size = children.size();
+
+    for(unsigned int i = 0; i < size; i++) children[i]->clearTermIds();
 }
 
 /**
- * @brief This function will recursively sort all the children of every Term by the order as follow.
+ * @brief This function will recursively sort all the children of every Term in the order in which they were created.
  *
- * - First PropositionalVariable and BooleanConstant
- * - Second BooleanOperation with a lot of children.
- * - Third  BooleanOperation with few children.
- * - Last   ModalOperator.
+ * The children are checked in this order, which gives the reason of a {KO,UNKNOWN} result.
+ * The order of operator< is only used with the order by cost (see Formula::orderChildrenByCost).
  */
 void Term::orderChildren() {
 
@@ -122,7 +147,7 @@ void Term::orderChildren() {
 
     if(size > 0) {
 
-        sort(children.begin(), children.end());
+        stable_sort(children.begin(), children.end(), [](Term* t1, Term* t2) { return t1->creation < t2->creation; });
         
         for(unsigned int i = 0; i < size; i++) children[i]->orderChildren();
     }
@@ -144,17 +169,12 @@ void Term::orderChildren() {
  */
  bool operator<(Term & t1, Term & t2) {
 
-    unsigned int nbChildrenT1 = t1.getNbChildren();
-    unsigned int nbChildrenT2 = t2.getNbChildren();
-
     /* If one of them is a Variable, it should be first. */
-    if(nbChildrenT1 == 0) return true;
-    if(nbChildrenT2 == 0) return false;
+    if(!t1.isOperation() || !t2.isOperation()) return !t1.isOperation() && t2.isOperation();
 
     /* If one of them is a ModalOperator, it should be last. */
-    if(nbChildrenT1 == 1) return false;
-    if(nbChildrenT2 == 1) return true;
+    if(t1.getKind() == K_MODAL || t2.getKind() == K_MODAL) return t1.getKind() != K_MODAL && t2.getKind() == K_MODAL;
 
     /* If not, we just sort BooleanOperation with the one with the more children first. */
-    return (nbChildrenT1 > nbChildrenT2);
+    return (t1.getNbChildren() > t2.getNbChildren());
  }
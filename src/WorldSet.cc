@@ -0,0 +1,165 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+/**
+ * \file WorldSet.cc
+ * @brief Implementation of WorldSet::methods which are not in the WorldSet.h
+ *
+ * The AVX2 and AVX-512 kernels are compiled with a target attribute,
+ * so the binary runs everywhere and uses them only if the CPU has them.
+ *
+ * @version 1.0
+ */
+
+#include "../include/WorldSet.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define WORLD_SET_X86 1
+#endif
+
+/**
+ * @brief ok &= ok2 and ko |= ko2 on n words, one word at a time.
+ */
+static void andScalar(uint64_t* ok, uint64_t* ko, const uint64_t* ok2, const uint64_t* ko2, size_t n) {
+
+  for(size_t i = 0; i < n; i++) {
+    ok[i] &= ok2[i];
+    ko[i] |= ko2[i];
+  }
+}
+
+#ifdef WORLD_SET_X86
+
+/**
+ * @brief ok &= ok2 and ko |= ko2 on n words, 4 words at a time.
+ */
+__attribute__((target("avx2")))
+static void andAVX2(uint64_t* ok, uint64_t* ko, const uint64_t* ok2, const uint64_t* ko2, size_t n) {
+
+  size_t i = 0;
+
+  for(; i + 4 <= n; i += 4) {
+
+    __m256i a = _mm256_loadu_si256((const __m256i*) (ok + i));
+    __m256i b = _mm256_loadu_si256((const __m256i*) (ok2 + i));
+    _mm256_storeu_si256((__m256i*) (ok + i), _mm256_and_si256(a,b));
+
+    __m256i c = _mm256_loadu_si256((const __m256i*) (ko + i));
+    __m256i d = _mm256_loadu_si256((const __m256i*) (ko2 + i));
+    _mm256_storeu_si256((__m256i*) (ko + i), _mm256_or_si256(c,d));
+  }
+
+  andScalar(ok + i, ko + i, ok2 + i, ko2 + i, n - i);
+}
+
+/**
+ * @brief ok &= ok2 and ko |= ko2 on n words, 8 words at a time.
+ */
+__attribute__((target("avx512f")))
+static void andAVX512(uint64_t* ok, uint64_t* ko, const uint64_t* ok2, const uint64_t* ko2, size_t n) {
+
+  size_t i = 0;
+
+  for(; i + 8 <= n; i += 8) {
+
+    __m512i a = _mm512_loadu_si512((const void*) (ok + i));
+    __m512i b = _mm512_loadu_si512((const void*) (ok2 + i));
+    _mm512_storeu_si512((void*) (ok + i), _mm512_and_si512(a,b));
+
+    __m512i c = _mm512_loadu_si512((const void*) (ko + i));
+    __m512i d = _mm512_loadu_si512((const void*) (ko2 + i));
+    _mm512_storeu_si512((void*) (ko + i), _mm512_or_si512(c,d));
+  }
+
+  andScalar(ok + i, ko + i, ok2 + i, ko2 + i, n - i);
+}
+
+#endif
+
+/**
+ * @brief This function will choose the best kernel for the current CPU.
+ *
+ * @param[out] name the name of the chosen kernel.
+ *
+ * @return the best kernel for the current CPU.
+ */
+static WorldSet::kernel_t chooseKernel(const char* & name) {
+
+#ifdef WORLD_SET_X86
+  __builtin_cpu_init();
+
+  if(__builtin_cpu_supports("avx512f")) { name = "avx512"; return andAVX512; }
+
+  if(__builtin_cpu_supports("avx2"))    { name = "avx2";   return andAVX2; }
+#endif
+
+  name = "scalar";
+  return andScalar;
+}
+
+const char* WorldSet::kernelName = "scalar";
+
+WorldSet::kernel_t WorldSet::andKernel = chooseKernel(WorldSet::kernelName);
+
+/**
+ * @brief This method will resize the set for nbWorlds worlds and give them all the same label.
+ *
+ * @param[in] nbWorlds the number of worlds in the Kripke model.
+ *
+ * @param[in] value the label {OK,KO,UNKNOWN} of every world.
+ */
+void WorldSet::assign(unsigned int nbWorlds, unsigned int value) {
+
+  size_t n = nbWords(nbWorlds);
+
+  ok.assign(n, 0);
+  ko.assign(n, 0);
+
+  vector<uint64_t> & full = (value == OK) ? ok : ko;
+
+  if(value == UNKNOWN || n == 0) return;
+
+  /* The bits after the last world stay at 0. */
+  for(size_t i = 0; i < n; i++) full[i] = ~(uint64_t) 0;
+  if(nbWorlds & 63) full[n-1] = ((uint64_t) 1 << (nbWorlds & 63)) - 1;
+}
+
+/**
+ * @brief This method will copy the bitsets given as the 'ok' and 'ko' parts of the set.
+ *
+ * @param[in] nbWorlds the number of worlds in the Kripke model.
+ *
+ * @param[in] okWords the worlds which are OK (nbWords(nbWorlds) words).
+ *
+ * @param[in] koWords the worlds which are KO (nbWords(nbWorlds) words).
+ */
+void WorldSet::assign(unsigned int nbWorlds, const uint64_t* okWords, const uint64_t* koWords) {
+
+  size_t n = nbWords(nbWorlds);
+
+  ok.assign(okWords, okWords + n);
+  ko.assign(koWords, koWords + n);
+}
@@ -0,0 +1,130 @@
+/****************************************************************************************
+* Copyright (c) 2016 Artois University
+*
+* This file is part of MDK-Verifier
+*
+* MDK-Verifier is free software: you can redistribute it and/or modify it
+* under the terms of the GNU General Public License as published by the Free Software Foundation,
+* either version 3 of the License, or (at your option) any later version.
+*
+* MDK-Verifier is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+* without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+* See the GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License along with MDK-Verifier.
+* If not, see http://www.gnu.org/licenses/.
+*
+# Contributors:
+#   - Jean Marie Lagniez  (lagniez@cril.fr)
+#   - Daniel Le Berre     (leberre@cril.fr)
+#     - Tiago de Lima     (delima@cril.fr)
+#   - Valentin Montmirail (montmirail@cril.fr)
+***************************************************************************************************/
+
+/**
+ * \file CheckCacheTest.cc
+ * @brief The tests of the CheckCache which can not be reached from a formula of a reasonable size (run by make test).
+ *
+ * @version 1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../include/CheckCache.h"
+
+/** @brief The number of failed expectations. */
+static unsigned int nbFailures = 0;
+
+/**
+ * @brief This function will compare a result read in the cache with the expected one.
+ *
+ * @param[in] what the name of the expectation, displayed if it fails.
+ *
+ * @param[in] got the result read in the cache.
+ *
+ * @param[in] expected the result which should have been read.
+ */
+static void expect(const char* what, unsigned int got, unsigned int expected) {
+
+  if(got == expected) return;
+
+  printf("FAIL: %s (got %u, expected %u)\n", what, got, expected);
+  nbFailures++;
+}
+
+/**
+ * @brief In a dense table, every result (KO is stored as the bits 11) is read back, and does not change its neighbours.
+ */
+static void testDense() {
+
+  CheckCache cache(16, 5, 1 << 20);
+
+  expect("dense table", cache.isDense(), true);
+  expect("dense empty entry", cache.lookup(3, 2), NOT_YET);
+
+  cache.store(3, 1, OK);
+  cache.store(3, 2, KO);
+  cache.store(3, 3, UNKNOWN);
+
+  expect("dense OK", cache.lookup(3, 1), OK);
+  expect("dense KO", cache.lookup(3, 2), KO);
+  expect("dense UNKNOWN", cache.lookup(3, 3), UNKNOWN);
+  expect("dense neighbour", cache.lookup(3, 4), NOT_YET);
+
+  /* A shared table only sets bits (atomically), which is right since an entry is only stored while it is empty. */
+  CheckCache shared(16, 5, 1 << 20);
+  shared.setShared(true);
+  shared.store(7, 0, KO);
+  shared.store(7, 1, OK);
+
+  expect("shared KO", shared.lookup(7, 0), KO);
+  expect("shared OK", shared.lookup(7, 1), OK);
+}
+
+/**
+ * @brief In a hashed table, the terms t and t + 2^30 used to be the same key once in a slot (the top bits of the term were shifted out).
+ */
+static void testHashedHighTerms() {
+
+  /* More than 2^31 terms in 4 worlds do not fit in 32 KB, so the table is hashed, with few buckets. */
+  CheckCache cache((1u << 31) + 16, 4, 1 << 15);
+
+  expect("hashed table", cache.isDense(), false);
+
+  cache.store(5, 1, KO);
+  cache.store((1u << 30) + 5, 1, OK);
+  cache.store((1u << 31) + 5, 1, UNKNOWN);
+
+  expect("hashed low term", cache.lookup(5, 1), KO);
+  expect("hashed term 2^30 + 5", cache.lookup((1u << 30) + 5, 1), NOT_YET);
+  expect("hashed term 2^31 + 5", cache.lookup((1u << 31) + 5, 1), NOT_YET);
+
+  cache.store((1u << 30) - 1, 3, UNKNOWN);
+
+  expect("hashed last term", cache.lookup((1u << 30) - 1, 3), UNKNOWN);
+
+  /* The terms t and t + 2^30 only meet if they are in the same bucket, so many of them are stored. */
+  unsigned int nbAliases = 0;
+
+  for(unsigned int t = 0; t < (1u << 16); t++) cache.store((1u << 30) + t, 2, OK);
+
+  for(unsigned int t = 0; t < (1u << 16); t++) if(cache.lookup(t, 2) != NOT_YET) nbAliases++;
+
+  expect("hashed terms t read as t + 2^30", nbAliases, 0);
+}
+
+/**
+ * @brief The main function will run every test and display how many failed.
+ *
+ * @return EXIT_SUCCESS if every test passed, EXIT_FAILURE otherwise.
+ */
+int main() {
+
+  testDense();
+  testHashedHighTerms();
+
+  printf("CheckCache: %u failure(s)\n", nbFailures);
+
+  return nbFailures == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
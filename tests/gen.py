@@ -0,0 +1,50 @@
+# Generates random formulae and Kripke models, to compare the engines and the options of the verifier (see tests/run.sh).
+#
+# Usage: python3 tests/gen.py directory number [maxWorlds]
+#
+# The case i is directory/fi.ih and directory/mi.kcnf, the same for a given i on every run.
+
+import random, sys, os
+def formula(r, nv, d):
+    if d == 0 or r.random() < 0.15:
+        x = r.random()
+        if x < 0.05: return r.choice(["true","false"])
+        v = "p%d" % r.randint(1, nv)
+        return ("~"+v) if r.random()<0.4 else v
+    k = r.random()
+    if k < 0.3:
+        return "(%s %s %s)" % (formula(r,nv,d-1), r.choice(["&","|","->"]), formula(r,nv,d-1))
+    if k < 0.35:
+        return "(p%d <-> p%d)" % (r.randint(1,nv), r.randint(1,nv))
+    if k < 0.45:
+        return "~(%s)" % formula(r,nv,d-1)
+    op = r.choice(["[r1]","<r1>"])
+    if r.random() < 0.3:
+        return op + op + "(" + formula(r,nv,d-1) + ")"
+    return op + "(" + formula(r,nv,d-1) + ")"
+def model(r, nv, nw):
+    out = ["c random", "s SATISFIABLE"]
+    edges = []
+    for w in range(nw):
+        k = r.choice([0,1,1,1,2,3])
+        for _ in range(k):
+            edges.append((w, r.randrange(nw) if r.random()<0.2 else min(nw-1, w+r.randint(1,3))))
+    out.append("v %d %d %d" % (nv, nw, len(edges)))
+    full = r.random() < 0.5
+    for w in range(nw):
+        lits = []
+        for v in range(1, nv+1):
+            x = r.random()
+            if full or x < 0.8:
+                lits.append(str(v if r.random()<0.5 else -v))
+        out.append("v " + " ".join(lits + ["0"]))
+    for a,b in edges:
+        out.append("v r1 w%d w%d" % (a,b))
+    return "\n".join(out) + "\n"
+d = sys.argv[1]; n = int(sys.argv[2]); W = int(sys.argv[3]) if len(sys.argv) > 3 else 12
+os.makedirs(d, exist_ok=True)
+for i in range(n):
+    r = random.Random(i)
+    nv = r.randint(1, 6); nw = r.randint(1, W)
+    open("%s/f%d.ih" % (d,i),"w").write(formula(r, nv, r.randint(1,7)) + "\n")
+    open("%s/m%d.kcnf" % (d,i),"w").write(model(r, nv, nw))
@@ -0,0 +1,116 @@
+#!/bin/sh
+# Runs the regression cases, the binary models and the random cases against the verifier (make test).
+#
+# Usage: tests/run.sh [verifier] [number of random cases]
+#
+# - tests/regression/NAME.ih is checked with NAME.kcnf, by every engine, as a path and on the STDIN:
+#   the first line has to give the verdict of NAME.expected;
+# - a binary model is written, then truncated and corrupted: it has to be refused, not read;
+# - the random cases of tests/gen.py are checked with every engine and option, which have to give the verdict
+#   of the recursive engine (and the same output for the options which do not change the reason).
+
+VERIFIER=${1:-./bin/mdk-verifier}
+NB_RANDOM=${2:-200}
+TESTS=$(dirname "$0")
+TMP=$(mktemp -d)
+trap 'rm -rf "$TMP"' EXIT
+
+# The verdict of an output: OK and the number of worlds, ERROR or UNKNOWN.
+verdict() {
+  head -1 | awk '{ print $1, ($1 == "OK") ? $2 : "" }'
+}
+
+# Runs the verifier, a loop counts as a failure.
+run() {
+  timeout 10 "$VERIFIER" "$@" 2>/dev/null || [ $? -ne 124 ] || echo "TIMEOUT"
+}
+
+nbFailures=0
+
+fail() {
+  echo "FAIL: $*"
+  nbFailures=$((nbFailures + 1))
+}
+
+ENGINES="recursive labeling parallel iterative bytecode store"
+
+for f in "$TESTS"/regression/*.ih; do
+  name=${f%.ih}
+  expected=$(verdict < "$name.expected")
+
+  for e in $ENGINES; do
+    for o in "" "-m 0" "-m 1 -P" "-a -d -s" "-o" "-b" "-S -C"; do
+      got=$(run -e $e -j 2 $o "$f" "$name.kcnf" | verdict)
+      [ "$got" = "$expected" ] || fail "$(basename $name) -e $e $o: '$got' instead of '$expected'"
+    done
+
+    got=$(run -e $e "$f" < "$name.kcnf" | verdict)
+    [ "$got" = "$expected" ] || fail "$(basename $name) -e $e (STDIN): '$got' instead of '$expected'"
+  done
+done
+
+# A binary model is read without parsing, so every count and every offset has to be checked before it is used.
+f=$TESTS/regression/ok_deep.ih
+model=$TMP/model.mdkb
+run -w "$model" "$f" "${f%.ih}.kcnf" > /dev/null
+
+if [ ! -s "$model" ]; then
+  fail "the binary model was not written"
+else
+  expected=$(verdict < "${f%.ih}.expected")
+  got=$(run "$f" "$model" | verdict)
+  [ "$got" = "$expected" ] || fail "binary model: '$got' instead of '$expected'"
+
+  size=$(wc -c < "$model")
+  head -c $((size - 4)) "$model" > "$TMP/truncated.mdkb"
+  head -c 20 "$model" > "$TMP/header.mdkb"
+
+  # The last 4 bytes are the target of the last edge, which becomes a world that does not exist.
+  cp "$model" "$TMP/target.mdkb"
+  printf '\377\377\377\377' | dd of="$TMP/target.mdkb" bs=1 seek=$((size - 4)) conv=notrunc 2>/dev/null
+
+  # The bytes 16 to 23 are the number of edges.
+  cp "$model" "$TMP/edges.mdkb"
+  printf '\377\377\377\377\377\377\377\177' | dd of="$TMP/edges.mdkb" bs=1 seek=16 conv=notrunc 2>/dev/null
+
+  for b in truncated header target edges; do
+    got=$(run "$f" "$TMP/$b.mdkb" | head -1)
+    [ "$got" = "ERROR: the binary model is truncated or corrupted." ] || fail "$b binary model: '$got'"
+
+    got=$(run "$f" < "$TMP/$b.mdkb" | head -1)
+    [ "$got" = "ERROR: the binary model is truncated or corrupted." ] || fail "$b binary model (STDIN): '$got'"
+  done
+fi
+
+# The random cases: every engine and option against the recursive engine.
+python3 "$TESTS/gen.py" "$TMP/random" "$NB_RANDOM" > /dev/null || fail "tests/gen.py"
+
+i=0
+while [ $i -lt "$NB_RANDOM" ]; do
+  f=$TMP/random/f$i.ih
+  m=$TMP/random/m$i.kcnf
+  reference=$(run "$f" "$m")
+  expected=$(echo "$reference" | verdict)
+
+  for e in $ENGINES; do
+    for o in "" "-o" "-b" "-P" "-j 1"; do
+      got=$(run -e $e $o "$f" "$m" | verdict)
+      [ "$got" = "$expected" ] || fail "random $i -e $e $o: '$got' instead of '$expected'"
+    done
+  done
+
+  # These options change how the formula is checked, not which child gives the reason.
+  for o in "-m 0" "-m 0 -P" "-a" "-d" "-s" "-S -C" "-e iterative" "-e bytecode" "-e store"; do
+    got=$(run $o "$f" "$m")
+    [ "$got" = "$reference" ] || fail "random $i $o: the output differs from the recursive engine"
+  done
+
+  got=$(run "$f" < "$m")
+  [ "$got" = "$reference" ] || fail "random $i (STDIN): the output differs from the recursive engine"
+
+  i=$((i + 1))
+done
+
+echo "tests: $nbFailures failure(s)"
+
+[ $nbFailures -eq 0 ]